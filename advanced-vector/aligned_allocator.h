@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Аллокатор, выравнивающий буферы по границе Alignment байт: 64 для кэш-линий и AVX-512,
+// 4096 для страниц или 2 МиБ для огромных страниц. Использует operator new с std::align_val_t.
+// С std::allocator буферы выравниваются лишь по alignof(T) (не меньше __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+template <typename T, size_t Alignment>
+class AlignedAllocator {
+	static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+	static_assert(Alignment >= alignof(T), "Alignment is weaker than the element type requires");
+
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	// Выравнивание, которое гарантируется для каждого буфера. Vector использует его в AssumeAligned
+	static constexpr size_t ALIGNMENT = Alignment;
+
+	template <typename U>
+	struct rebind {
+		using other = AlignedAllocator<U, Alignment>;
+	};
+
+	AlignedAllocator() = default;
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+	}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+	}
+
+	void deallocate(T* p, size_t /*n*/) noexcept {
+		operator delete(p, std::align_val_t{ Alignment });
+	}
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+		return false;
+	}
+};
@@ -0,0 +1,982 @@
+#include "vector.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "vector_algorithms.h"
+#include "parallel_vector.h"
+#include "pool_allocator.h"
+#include "stable_vector.h"
+#include "static_vector.h"
+#include "incremental_vector.h"
+#include "mmap_vector.h"
+#include "numa_allocator.h"
+#include "serialization.h"
+#include "soa_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Счётчик памяти, одновременно выделенной через TrackingAllocator
+struct MemoryCounter {
+    static void Reset() {
+        current_bytes = 0;
+        peak_bytes = 0;
+    }
+
+    static inline size_t current_bytes = 0;
+    static inline size_t peak_bytes = 0;
+};
+
+// Аллокатор, который отслеживает пиковый объём выделенной памяти. В отличие от RSS процесса,
+// этот показатель можно измерить отдельно для каждого прогона
+template <typename T>
+struct TrackingAllocator {
+    using value_type = T;
+
+    TrackingAllocator() = default;
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        MemoryCounter::current_bytes += n * sizeof(T);
+        MemoryCounter::peak_bytes = std::max(MemoryCounter::peak_bytes, MemoryCounter::current_bytes);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        MemoryCounter::current_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Тривиально копируемая структура размером в кэш-линию
+struct Pod64 {
+    uint64_t fields[8];
+};
+
+// Аналог Obj из тестов: копирование может выбросить исключение, а перемещение не помечено noexcept,
+// поэтому при росте вектор обязан копировать элементы
+struct ThrowingCopyObj {
+    ThrowingCopyObj() = default;
+
+    explicit ThrowingCopyObj(int id)
+        : id(id) {
+    }
+
+    ThrowingCopyObj(const ThrowingCopyObj& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+    }
+
+    ThrowingCopyObj(ThrowingCopyObj&& other)
+        : id(other.id) {
+    }
+
+    ThrowingCopyObj& operator=(const ThrowingCopyObj& other) = default;
+    ThrowingCopyObj& operator=(ThrowingCopyObj&& other) = default;
+
+    bool throw_on_copy = false;
+    int id = 0;
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<int>(i);
+    }
+    else if constexpr (std::is_same_v<T, Pod64>) {
+        return Pod64{ {i, i, i, i, i, i, i, i} };
+    }
+    else if constexpr (std::is_same_v<T, std::string>) {
+        // Строка длиннее буфера SSO, чтобы копирование обращалось к куче
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+    else {
+        return T(static_cast<int>(i));
+    }
+}
+
+// Единый интерфейс к Vector и std::vector, чтобы одни и те же замеры работали для обоих контейнеров
+template <typename T, typename Allocator, typename GrowthPolicy>
+void PushBack(Vector<T, Allocator, GrowthPolicy>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T>
+void PushBack(std::vector<T>& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T>
+void EmplaceBack(Vector<T>& v, size_t i) {
+    v.EmplaceBack(MakeValue<T>(i));
+}
+
+template <typename T>
+void EmplaceBack(std::vector<T>& v, size_t i) {
+    v.emplace_back(MakeValue<T>(i));
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+void InsertAt(Vector<T>& v, size_t index, const T& value) {
+    v.Insert(v.begin() + index, value);
+}
+
+template <typename T>
+void InsertAt(std::vector<T>& v, size_t index, const T& value) {
+    v.insert(v.begin() + index, value);
+}
+
+template <typename T>
+void EraseAt(Vector<T>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename Container>
+Container MakeContainer(size_t size) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    Container c;
+    Reserve(c, size);
+    for (size_t i = 0; i != size; ++i) {
+        PushBack(c, MakeValue<T>(i));
+    }
+    return c;
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    const size_t count = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i != count; ++i) {
+            PushBack(c, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename Container>
+void BM_EmplaceBack(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i != count; ++i) {
+            EmplaceBack(c, i);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Стоимость переноса count элементов в буфер вдвое большей вместимости
+template <typename Container>
+void BM_ReserveGrowth(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container c = MakeContainer<Container>(count);
+        state.ResumeTiming();
+        Reserve(c, count * 2);
+        benchmark::DoNotOptimize(c.begin());
+        state.PauseTiming();
+        c = Container();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Вставка и удаление в середине вектора, каждая операция сдвигает половину элементов
+template <typename Container>
+void BM_InsertEraseMiddle(benchmark::State& state) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    const size_t count = static_cast<size_t>(state.range(0));
+    Container c = MakeContainer<Container>(count);
+    Reserve(c, count + 1);
+    const T value = MakeValue<T>(0);
+    for (auto _ : state) {
+        InsertAt(c, count / 2, value);
+        EraseAt(c, count / 2);
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Три ветви копирующего присваивания: rhs не помещается в вместимость приемника (0),
+// rhs короче приемника (1) и rhs длиннее приемника, но помещается в его вместимость (2)
+template <typename Container>
+void BM_CopyAssign(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const int branch = static_cast<int>(state.range(1));
+    const size_t lhs_size = branch == 1 ? count * 2 : count / 2;
+    const Container rhs = MakeContainer<Container>(count);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container lhs = MakeContainer<Container>(lhs_size);
+        if (branch == 2) {
+            Reserve(lhs, count);
+        }
+        state.ResumeTiming();
+        lhs = rhs;
+        benchmark::DoNotOptimize(lhs.begin());
+        state.PauseTiming();
+        lhs = Container();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Перемещающее присваивание в приемник большего (0) и меньшего (1) размера: буфер rhs забирается целиком
+template <typename Container>
+void BM_MoveAssign(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const size_t lhs_size = state.range(1) == 0 ? count * 2 : count / 2;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container lhs = MakeContainer<Container>(lhs_size);
+        Container rhs = MakeContainer<Container>(count);
+        state.ResumeTiming();
+        lhs = std::move(rhs);
+        benchmark::DoNotOptimize(lhs.begin());
+        state.PauseTiming();
+        lhs = Container();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename T>
+size_t Weight(const T& value) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<size_t>(value);
+    }
+    else if constexpr (std::is_same_v<T, Pod64>) {
+        return value.fields[0];
+    }
+    else if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    }
+    else {
+        return static_cast<size_t>(value.id);
+    }
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const Container c = MakeContainer<Container>(count);
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (const auto& value : c) {
+            sum += Weight(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * sizeof(*c.begin()));
+}
+
+template <typename Container>
+void RegisterContainer(const std::string& container_name) {
+    const struct {
+        const char* name;
+        void (*function)(benchmark::State&);
+    } benchmarks[] = {
+        {"PushBack", BM_PushBack<Container>},
+        {"EmplaceBack", BM_EmplaceBack<Container>},
+        {"ReserveGrowth", BM_ReserveGrowth<Container>},
+        {"Iterate", BM_Iterate<Container>},
+    };
+    for (const auto& bm : benchmarks) {
+        benchmark::RegisterBenchmark((std::string(bm.name) + "/" + container_name).c_str(), bm.function)
+            ->RangeMultiplier(16)
+            ->Range(1 << 8, 1 << 16);
+    }
+    benchmark::RegisterBenchmark(("InsertEraseMiddle/" + container_name).c_str(), BM_InsertEraseMiddle<Container>)
+        ->RangeMultiplier(16)
+        ->Range(1 << 8, 1 << 16);
+    benchmark::RegisterBenchmark(("CopyAssign/" + container_name).c_str(), BM_CopyAssign<Container>)
+        ->ArgNames({"size", "branch"})
+        ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1, 2}});
+    benchmark::RegisterBenchmark(("MoveAssign/" + container_name).c_str(), BM_MoveAssign<Container>)
+        ->ArgNames({"size", "branch"})
+        ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}});
+}
+
+template <typename T>
+void RegisterType(const std::string& type_name) {
+    RegisterContainer<Vector<T>>("Vector<" + type_name + ">");
+    RegisterContainer<std::vector<T>>("std::vector<" + type_name + ">");
+}
+
+template <typename GrowthPolicy>
+void BM_GrowthPolicy(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    size_t capacity = 0;
+    for (auto _ : state) {
+        MemoryCounter::Reset();
+        Vector<uint64_t, TrackingAllocator<uint64_t>, GrowthPolicy> v;
+        for (size_t i = 0; i != count; ++i) {
+            v.PushBack(i);
+        }
+        capacity = v.Capacity();
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    // Пиковый объём памяти включает старый и новый буферы во время последнего роста
+    state.counters["peak_bytes"] = static_cast<double>(MemoryCounter::peak_bytes);
+    state.counters["capacity_per_size"] = static_cast<double>(capacity) / count;
+}
+
+void RegisterGrowthPolicies() {
+    const int64_t COUNT = 1 << 24;
+    benchmark::RegisterBenchmark("GrowthPolicy/DoublingGrowth", BM_GrowthPolicy<DoublingGrowth>)->Arg(COUNT);
+    benchmark::RegisterBenchmark("GrowthPolicy/OneAndHalfGrowth", BM_GrowthPolicy<OneAndHalfGrowth>)->Arg(COUNT);
+    benchmark::RegisterBenchmark("GrowthPolicy/SizeClassGrowth", BM_GrowthPolicy<SizeClassGrowth>)->Arg(COUNT);
+    benchmark::RegisterBenchmark("GrowthPolicy/HugePageGrowth", BM_GrowthPolicy<HugePageGrowth>)->Arg(COUNT);
+}
+
+// Алгоритмы из vector_algorithms.h на каждом поддерживаемом наборе инструкций (-1 означает
+// соответствующий алгоритм std::) над вектором из 64 Кб элементов, помещающимся в кэш L2
+enum class Algorithm {
+    FILL,
+    FIND,
+    COUNT,
+    SUM,
+    MIN_MAX,
+    TRANSFORM,
+};
+
+template <typename T, Algorithm ALGORITHM>
+void BM_Algorithm(benchmark::State& state) {
+    const int level_arg = static_cast<int>(state.range(0));
+    const SimdLevel level = static_cast<SimdLevel>(level_arg);
+    const size_t count = 1 << 16;
+    Vector<T> v(count);
+    for (size_t i = 0; i != count; ++i) {
+        v[i] = static_cast<T>(i % 100);
+    }
+    // Искомое значение отсутствует, чтобы поиск просматривал весь вектор
+    const T missing = static_cast<T>(101);
+    Vector<T> out(count);
+    for (auto _ : state) {
+        if constexpr (ALGORITHM == Algorithm::FILL) {
+            level_arg < 0 ? std::fill(v.begin(), v.end(), missing) : Fill(v.begin(), count, missing, level);
+            benchmark::ClobberMemory();
+        }
+        else if constexpr (ALGORITHM == Algorithm::FIND) {
+            benchmark::DoNotOptimize(level_arg < 0 ? static_cast<size_t>(std::find(v.begin(), v.end(), missing) - v.begin())
+                                                   : Find(v.begin(), count, missing, level));
+        }
+        else if constexpr (ALGORITHM == Algorithm::COUNT) {
+            benchmark::DoNotOptimize(level_arg < 0 ? static_cast<size_t>(std::count(v.begin(), v.end(), T{1}))
+                                                   : Count(v.begin(), count, T{1}, level));
+        }
+        else if constexpr (ALGORITHM == Algorithm::SUM) {
+            benchmark::DoNotOptimize(level_arg < 0 ? std::accumulate(v.begin(), v.end(), T{}) : Sum(v.begin(), count, level));
+        }
+        else if constexpr (ALGORITHM == Algorithm::MIN_MAX) {
+            if (level_arg < 0) {
+                const auto [min, max] = std::minmax_element(v.begin(), v.end());
+                benchmark::DoNotOptimize(*min);
+                benchmark::DoNotOptimize(*max);
+            }
+            else {
+                benchmark::DoNotOptimize(MinMax(v.begin(), count, level));
+            }
+        }
+        else {
+            const auto scale = [](T x) { return static_cast<T>(x * 3 + 1); };
+            level_arg < 0 ? static_cast<void>(std::transform(v.begin(), v.end(), out.begin(), scale))
+                          : Transform(v.begin(), out.begin(), count, scale, level);
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+
+template <typename T>
+void RegisterAlgorithms(const std::string& type_name) {
+    const struct {
+        const char* name;
+        void (*function)(benchmark::State&);
+    } benchmarks[] = {
+        {"Fill", BM_Algorithm<T, Algorithm::FILL>},
+        {"Find", BM_Algorithm<T, Algorithm::FIND>},
+        {"Count", BM_Algorithm<T, Algorithm::COUNT>},
+        {"Sum", BM_Algorithm<T, Algorithm::SUM>},
+        {"MinMax", BM_Algorithm<T, Algorithm::MIN_MAX>},
+        {"Transform", BM_Algorithm<T, Algorithm::TRANSFORM>},
+    };
+    for (const auto& bm : benchmarks) {
+        auto* registered = benchmark::RegisterBenchmark((std::string(bm.name) + "<" + type_name + ">").c_str(), bm.function)
+                               ->ArgName("simd")
+                               ->Arg(-1);
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON}) {
+            if (IsSimdLevelSupported(level)) {
+                registered->Arg(static_cast<int>(level));
+            }
+        }
+    }
+}
+
+// Копирование большого вектора строк в нескольких потоках. threads:1 соответствует конструктору копирования
+void BM_ParallelCopy(benchmark::State& state) {
+    const size_t threads = static_cast<size_t>(state.range(0));
+    const auto source = MakeContainer<Vector<std::string>>(1 << 20);
+    for (auto _ : state) {
+        auto copy = ParallelCopy(source, threads);
+        benchmark::DoNotOptimize(copy.begin());
+        state.PauseTiming();
+        ParallelDestroy(copy, threads);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * source.Size());
+}
+
+// Создание большого вектора и параллельный проход по нему теми же частями. Аргумент first_touch:1 создаёт
+// элементы через ParallelConstruct, и страницы размещаются на узлах обрабатывающих их потоков; first_touch:0
+// создаёт их в одном потоке, и на многоузловой машине все страницы оказываются на одном узле
+void BM_FirstTouchScan(benchmark::State& state) {
+    const bool first_touch = state.range(0) != 0;
+    const size_t threads = static_cast<size_t>(state.range(1));
+    constexpr size_t SIZE = size_t{1} << 24;
+    using NumaVector = Vector<uint64_t, NumaAllocator<uint64_t>>;
+    for (auto _ : state) {
+        NumaVector v = first_touch ? ParallelConstruct<uint64_t, NumaAllocator<uint64_t>>(SIZE, threads) : NumaVector(SIZE);
+        std::atomic<uint64_t> total = 0;
+        for (int pass = 0; pass != 4; ++pass) {
+            ParallelFor(SIZE, threads, [&v, &total](size_t begin, size_t end) {
+                total += std::accumulate(v.begin() + begin, v.begin() + end, uint64_t{0});
+            });
+        }
+        benchmark::DoNotOptimize(total.load());
+    }
+    state.SetBytesProcessed(state.iterations() * SIZE * sizeof(uint64_t) * 5);
+}
+
+// Раздача читателям копии большого вектора строк: Vector копирует все элементы, CowVector разделяет буфер
+template <typename Container>
+void BM_SnapshotCopy(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const Container source(MakeContainer<Vector<std::string>>(size));
+    for (auto _ : state) {
+        Container snapshot(source);
+        benchmark::DoNotOptimize(&snapshot);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Короткоживущий список из не более чем 16 элементов, например маршрут запроса: Vector выделяет
+// буфер в куче при каждом заполнении, StaticVector хранит элементы в самом объекте
+template <typename Container>
+void BM_BoundedList(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Container hops;
+        for (size_t i = 0; i != count; ++i) {
+            hops.EmplaceBack(static_cast<uint32_t>(i));
+        }
+        benchmark::DoNotOptimize(hops.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Сумма элементов вектора, помещающегося в кэш L2 и не помещающегося в кэш. Бенчмарки собираются с assert,
+// поэтому operator[] проверяет индекс на каждом элементе, а UncheckedAt и ForEachChunk — нет
+enum class SumAccess {
+    INDEX,
+    UNCHECKED,
+    CHUNKS,
+};
+
+void BM_SumAccess(benchmark::State& state) {
+    const auto access = static_cast<SumAccess>(state.range(0));
+    const size_t size = static_cast<size_t>(state.range(1));
+    Vector<uint32_t> v(size);
+    std::iota(v.begin(), v.end(), uint32_t{0});
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        if (access == SumAccess::INDEX) {
+            for (size_t i = 0; i != v.Size(); ++i) {
+                sum += v[i];
+            }
+        }
+        else if (access == SumAccess::UNCHECKED) {
+            for (size_t i = 0; i != v.Size(); ++i) {
+                sum += v.UncheckedAt(i);
+            }
+        }
+        else {
+            std::as_const(v).ForEachChunk([&sum](Span<const uint32_t> chunk) {
+                sum = std::accumulate(chunk.begin(), chunk.end(), sum);
+            });
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * size * sizeof(uint32_t));
+}
+
+// Приём 16 МиБ пакетами по 1500 байт: побайтовый PushBack из буфера пакета и AppendFrom,
+// при котором пакет копируется сразу в свободную часть вектора
+template <bool IN_PLACE>
+void BM_ReceivePackets(benchmark::State& state) {
+    const size_t PACKET_SIZE = 1500;
+    const size_t total = static_cast<size_t>(state.range(0));
+    const std::string stream(total, 'x');
+    for (auto _ : state) {
+        Vector<char> received;
+        size_t offset = 0;
+        if constexpr (IN_PLACE) {
+            received.AppendFrom([&](Span<char> spare) {
+                const size_t count = std::min({PACKET_SIZE, spare.Size(), stream.size() - offset});
+                std::memcpy(spare.Data(), stream.data() + offset, count);
+                offset += count;
+                return count;
+            }, PACKET_SIZE);
+        }
+        else {
+            char packet[PACKET_SIZE];
+            while (offset != stream.size()) {
+                const size_t count = std::min(PACKET_SIZE, stream.size() - offset);
+                std::memcpy(packet, stream.data() + offset, count);
+                offset += count;
+                for (size_t i = 0; i != count; ++i) {
+                    received.PushBack(packet[i]);
+                }
+            }
+        }
+        benchmark::DoNotOptimize(received.Data());
+    }
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+template <typename Map>
+Map MakeLookupTable(const Vector<uint64_t>& keys) {
+    Map map;
+    for (const uint64_t key : keys) {
+        map.emplace(key, key);
+    }
+    return map;
+}
+
+template <>
+FlatMap<uint64_t, uint64_t> MakeLookupTable(const Vector<uint64_t>& keys) {
+    Vector<std::pair<uint64_t, uint64_t>> entries;
+    entries.Reserve(keys.Size());
+    for (const uint64_t key : keys) {
+        entries.PushBack({key, key});
+    }
+    return FlatMap<uint64_t, uint64_t>(std::move(entries));
+}
+
+template <typename Map>
+const uint64_t* FindLookupEntry(const Map& map, uint64_t key) {
+    const auto pos = map.find(key);
+    return pos != map.end() ? &pos->second : nullptr;
+}
+
+template <typename Key, typename T>
+const uint64_t* FindLookupEntry(const FlatMap<Key, T>& map, uint64_t key) {
+    const auto pos = map.Find(key);
+    return pos != map.end() ? &pos->second : nullptr;
+}
+
+// Поиск случайных существующих ключей в таблице из size элементов. Ключи перемешаны, поэтому
+// переходы при поиске непредсказуемы, а соседние запросы обращаются к разным частям таблицы
+template <typename Map>
+void BM_Lookup(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const size_t LOOKUPS = 1024;
+    Vector<uint64_t> keys;
+    for (size_t i = 0; i != size; ++i) {
+        keys.PushBack(i * 0x9E3779B97F4A7C15ull);
+    }
+    const Map map = MakeLookupTable<Map>(keys);
+    Vector<uint64_t> queries;
+    for (size_t i = 0; i != LOOKUPS; ++i) {
+        queries.PushBack(keys[(i * 7919) % size]);
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const uint64_t key : queries) {
+            sum += *FindLookupEntry(map, key);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+// Заполнение FlatMap одной пакетной вставкой и поштучной вставкой в случайном порядке
+template <bool BULK>
+void BM_FlatMapBuild(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    Vector<std::pair<uint64_t, uint64_t>> entries;
+    for (size_t i = 0; i != size; ++i) {
+        const uint64_t key = i * 0x9E3779B97F4A7C15ull;
+        entries.PushBack({key, key});
+    }
+    for (auto _ : state) {
+        FlatMap<uint64_t, uint64_t> map;
+        if constexpr (BULK) {
+            map.InsertBulk(entries.begin(), entries.end());
+        }
+        else {
+            for (const auto& entry : entries) {
+                map.Insert(entry);
+            }
+        }
+        benchmark::DoNotOptimize(map.Elements().Data());
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Несколько потоков одновременно добавляют по count / threads элементов в общий контейнер
+template <typename Push>
+void RunProducers(size_t threads, size_t count, Push push) {
+    Vector<std::thread> producers;
+    for (size_t t = 0; t != threads; ++t) {
+        producers.EmplaceBack([push, per_thread = count / threads] {
+            for (size_t i = 0; i != per_thread; ++i) {
+                push(i);
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+}
+
+void BM_ConcurrentPushBack(benchmark::State& state) {
+    const size_t threads = static_cast<size_t>(state.range(0));
+    const size_t count = 1 << 20;
+    for (auto _ : state) {
+        ConcurrentVector<uint64_t> v;
+        RunProducers(threads, count, [&v](size_t i) {
+            v.PushBack(i);
+        });
+        benchmark::DoNotOptimize(v.Size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_MutexPushBack(benchmark::State& state) {
+    const size_t threads = static_cast<size_t>(state.range(0));
+    const size_t count = 1 << 20;
+    for (auto _ : state) {
+        Vector<uint64_t> v;
+        std::mutex mutex;
+        RunProducers(threads, count, [&v, &mutex](size_t i) {
+            std::lock_guard lock(mutex);
+            v.PushBack(i);
+        });
+        benchmark::DoNotOptimize(v.Size());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Распределение задержек одного PushBack при росте до count элементов: у Vector худший вызов переносит
+// все элементы в новый буфер, у StableVector выделяет один блок, у IncrementalVector переносит два элемента.
+// Процентили считаются по последнему прогону
+template <typename Container>
+void BM_PushBackLatency(benchmark::State& state) {
+    using Clock = std::chrono::steady_clock;
+    const size_t count = static_cast<size_t>(state.range(0));
+    const Pod64 value = MakeValue<Pod64>(1);
+    Vector<double> latencies;
+    latencies.Reserve(count);
+    for (auto _ : state) {
+        latencies.Clear();
+        Container c;
+        for (size_t i = 0; i != count; ++i) {
+            const auto start = Clock::now();
+            c.PushBack(value);
+            const std::chrono::duration<double, std::nano> latency = Clock::now() - start;
+            latencies.PushBack(latency.count());
+        }
+        benchmark::DoNotOptimize(&c[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return latencies[static_cast<size_t>(p * (latencies.Size() - 1))];
+    };
+    state.counters["p50_ns"] = percentile(0.5);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p99.9_ns"] = percentile(0.999);
+    state.counters["p99.99_ns"] = percentile(0.9999);
+    state.counters["max_ns"] = latencies[latencies.Size() - 1];
+}
+
+// Файл с элементами uint64_t для сравнения способов загрузки
+const char MMAP_BENCHMARK_FILE[] = "mmap_benchmark.bin";
+
+void WriteBenchmarkFile(size_t count) {
+    MmapVector<uint64_t> file(MMAP_BENCHMARK_FILE);
+    while (file.Size() > count) {
+        file.PopBack();
+    }
+    file.Reserve(count);
+    for (uint64_t i = file.Size(); i != count; ++i) {
+        file.PushBack(i);
+    }
+}
+
+// Загрузка индекса чтением элементов по одному: данные копируются в память процесса
+void BM_LoadStream(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    WriteBenchmarkFile(count);
+    for (auto _ : state) {
+        std::ifstream input(MMAP_BENCHMARK_FILE, std::ios::binary);
+        Vector<uint64_t> v;
+        uint64_t value;
+        while (input.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+            v.PushBack(value);
+        }
+        benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), uint64_t{0}));
+    }
+    state.SetBytesProcessed(state.iterations() * count * sizeof(uint64_t));
+}
+
+// Та же загрузка через отображение файла: открытие не копирует данные, а страницы берутся из кэша ОС
+void BM_LoadMmap(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    WriteBenchmarkFile(count);
+    for (auto _ : state) {
+        MmapVector<const uint64_t> v(MMAP_BENCHMARK_FILE);
+        v.Advise(AccessPattern::SEQUENTIAL);
+        benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), uint64_t{0}));
+    }
+    state.SetBytesProcessed(state.iterations() * count * sizeof(uint64_t));
+}
+
+// Сохранение и загрузка вектора циклом по operator[], как до появления Serialize
+void BM_SerializeLoop(benchmark::State& state) {
+    const Vector<uint64_t> v = MakeContainer<Vector<uint64_t>>(static_cast<size_t>(state.range(0)));
+    Vector<char> buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        BufferWriter writer(buffer);
+        const uint64_t size = v.Size();
+        writer.Write(&size, sizeof(size));
+        for (size_t i = 0; i != v.Size(); ++i) {
+            writer.Write(&v[i], sizeof(v[i]));
+        }
+        BufferReader reader(buffer.begin(), buffer.Size());
+        uint64_t count = 0;
+        reader.Read(&count, sizeof(count));
+        Vector<uint64_t> copy;
+        for (uint64_t i = 0; i != count; ++i) {
+            uint64_t value;
+            reader.Read(&value, sizeof(value));
+            copy.PushBack(value);
+        }
+        benchmark::DoNotOptimize(copy.begin());
+    }
+    state.SetBytesProcessed(state.iterations() * v.Size() * sizeof(uint64_t));
+}
+
+// Serialize и Deserialize с проверкой контрольной суммы: данные копируются одним блоком
+void BM_SerializeBulk(benchmark::State& state) {
+    const Vector<uint64_t> v = MakeContainer<Vector<uint64_t>>(static_cast<size_t>(state.range(0)));
+    Vector<char> buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        BufferWriter writer(buffer);
+        Serialize(v, writer);
+        BufferReader reader(buffer.begin(), buffer.Size());
+        const Vector<uint64_t> copy = Deserialize<uint64_t>(reader);
+        benchmark::DoNotOptimize(copy.begin());
+    }
+    state.SetBytesProcessed(state.iterations() * v.Size() * sizeof(uint64_t));
+}
+
+// Частица из двенадцати полей, из которых цикл ниже читает только два
+struct Particle {
+    double x, y, z;
+    double vx, vy, vz;
+    double ax, ay, az;
+    double mass, charge, radius;
+};
+
+using ParticleColumns = SoAVector<double, double, double, double, double, double, double, double, double, double,
+    double, double>;
+
+// Сумма x * vx по всем частицам: в Vector<Particle> из каждых 96 загруженных байт полезны 16
+void BM_ColumnScanAoS(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    Vector<Particle> particles(count);
+    for (size_t i = 0; i != count; ++i) {
+        particles[i].x = static_cast<double>(i);
+        particles[i].vx = 0.5;
+    }
+    for (auto _ : state) {
+        double sum = 0;
+        for (const Particle& particle : particles) {
+            sum += particle.x * particle.vx;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * count * 2 * sizeof(double));
+}
+
+// Тот же проход по двум столбцам SoAVector читает только нужные 16 байт на частицу
+void BM_ColumnScanSoA(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    ParticleColumns particles(count);
+    for (size_t i = 0; i != count; ++i) {
+        particles.Data<0>()[i] = static_cast<double>(i);
+        particles.Data<3>()[i] = 0.5;
+    }
+    for (auto _ : state) {
+        const Span<const double> x = std::as_const(particles).Column<0>();
+        const Span<const double> vx = std::as_const(particles).Column<3>();
+        double sum = 0;
+        for (size_t i = 0; i != x.Size(); ++i) {
+            sum += x[i] * vx[i];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * count * 2 * sizeof(double));
+}
+
+// Обработчик запроса создаёт несколько небольших векторов и уничтожает их. Потоки работают одновременно,
+// поэтому с std::allocator все выделения проходят через общий operator new
+template <typename Allocator>
+void BM_ShortLivedVectors(benchmark::State& state) {
+    const size_t threads = static_cast<size_t>(state.range(0));
+    constexpr size_t REQUESTS = 1 << 14;
+    for (auto _ : state) {
+        RunProducers(threads, REQUESTS, [](size_t request) {
+            Vector<int, Allocator> ids;
+            Vector<int, Allocator> scores;
+            for (size_t i = 0; i != 8 + request % 56; ++i) {
+                ids.PushBack(static_cast<int>(i));
+                scores.PushBack(static_cast<int>(request));
+            }
+            benchmark::DoNotOptimize(ids.begin());
+            benchmark::DoNotOptimize(scores.begin());
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * REQUESTS);
+}
+
+}  // namespace
+
+// Результаты в формате JSON для отслеживания регрессий: --benchmark_format=json или --benchmark_out=<файл>
+int main(int argc, char** argv) {
+    RegisterType<int>("int");
+    RegisterType<Pod64>("Pod64");
+    RegisterType<std::string>("string");
+    RegisterType<ThrowingCopyObj>("ThrowingCopyObj");
+    RegisterGrowthPolicies();
+    RegisterAlgorithms<int32_t>("int32_t");
+    RegisterAlgorithms<float>("float");
+    RegisterAlgorithms<double>("double");
+    benchmark::RegisterBenchmark("ParallelCopy<string>", BM_ParallelCopy)
+        ->ArgName("threads")
+        ->RangeMultiplier(2)
+        ->Range(1, 8)
+        ->UseRealTime();
+    for (auto [name, access] : {std::pair{"SumAccess/operator[]", SumAccess::INDEX},
+             std::pair{"SumAccess/UncheckedAt", SumAccess::UNCHECKED}, std::pair{"SumAccess/ForEachChunk", SumAccess::CHUNKS}}) {
+        benchmark::RegisterBenchmark(name, BM_SumAccess)
+            ->ArgNames({"access", "size"})
+            ->ArgsProduct({{static_cast<int>(access)}, {1 << 16, 1 << 24}});
+    }
+    benchmark::RegisterBenchmark("ReceivePackets/PushBack", BM_ReceivePackets<false>)->Arg(1 << 24);
+    benchmark::RegisterBenchmark("ReceivePackets/AppendFrom", BM_ReceivePackets<true>)->Arg(1 << 24);
+    for (auto [name, function] : {std::pair{"Lookup/FlatMap", BM_Lookup<FlatMap<uint64_t, uint64_t>>},
+             std::pair{"Lookup/std::map", BM_Lookup<std::map<uint64_t, uint64_t>>},
+             std::pair{"Lookup/std::unordered_map", BM_Lookup<std::unordered_map<uint64_t, uint64_t>>}}) {
+        benchmark::RegisterBenchmark(name, function)->RangeMultiplier(10)->Range(10, 1'000'000);
+    }
+    benchmark::RegisterBenchmark("FlatMapBuild/InsertBulk", BM_FlatMapBuild<true>)->Arg(10'000);
+    benchmark::RegisterBenchmark("FlatMapBuild/Insert", BM_FlatMapBuild<false>)->Arg(10'000);
+    benchmark::RegisterBenchmark("BoundedList/Vector<uint32_t>", BM_BoundedList<Vector<uint32_t>>)->Arg(16);
+    benchmark::RegisterBenchmark("BoundedList/StaticVector<uint32_t, 16>", BM_BoundedList<StaticVector<uint32_t, 16>>)
+        ->Arg(16);
+    benchmark::RegisterBenchmark("SnapshotCopy/Vector<string>", BM_SnapshotCopy<Vector<std::string>>)->Arg(1 << 16);
+    benchmark::RegisterBenchmark("SnapshotCopy/CowVector<string>", BM_SnapshotCopy<CowVector<std::string>>)->Arg(1 << 16);
+    benchmark::RegisterBenchmark("FirstTouchScan/NumaAllocator", BM_FirstTouchScan)
+        ->ArgNames({"first_touch", "threads"})
+        ->ArgsProduct({{0, 1}, {1, 4}})
+        ->UseRealTime();
+    for (auto [name, function] : {std::pair{"ConcurrentPushBack/ConcurrentVector", BM_ConcurrentPushBack},
+             std::pair{"ConcurrentPushBack/mutex+Vector", BM_MutexPushBack}}) {
+        benchmark::RegisterBenchmark(name, function)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+    }
+    benchmark::RegisterBenchmark("PushBackLatency/Vector<Pod64>", BM_PushBackLatency<Vector<Pod64>>)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("PushBackLatency/StableVector<Pod64>", BM_PushBackLatency<StableVector<Pod64>>)
+        ->Arg(1 << 20);
+    benchmark::RegisterBenchmark("PushBackLatency/IncrementalVector<Pod64>", BM_PushBackLatency<IncrementalVector<Pod64>>)
+        ->Arg(1 << 20);
+    benchmark::RegisterBenchmark("LoadFile/ifstream", BM_LoadStream)->Arg(1 << 22);
+    benchmark::RegisterBenchmark("LoadFile/MmapVector", BM_LoadMmap)->Arg(1 << 22);
+    benchmark::RegisterBenchmark("Serialize/loop", BM_SerializeLoop)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("Serialize/bulk", BM_SerializeBulk)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("ColumnScan/Vector<Particle>", BM_ColumnScanAoS)->Arg(1 << 10)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("ColumnScan/SoAVector", BM_ColumnScanSoA)->Arg(1 << 10)->Arg(1 << 20);
+    for (auto [name, function] : {std::pair{"ShortLivedVectors/std::allocator", BM_ShortLivedVectors<std::allocator<int>>},
+             std::pair{"ShortLivedVectors/PoolAllocator", BM_ShortLivedVectors<PoolAllocator<int>>}}) {
+        benchmark::RegisterBenchmark(name, function)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    std::remove(MMAP_BENCHMARK_FILE);
+}
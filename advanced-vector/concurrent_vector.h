@@ -0,0 +1,172 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <climits>
+#include <new>
+
+// Вектор, в который можно одновременно добавлять элементы из нескольких потоков.
+// Элементы хранятся в сегментах (корзинах) из RawMemory, размер которых удваивается: корзина b вмещает
+// FIRST_BUCKET_SIZE << b элементов. Корзины никогда не перевыделяются, поэтому элементы не перемещаются,
+// а ссылки на них остаются действительными до уничтожения вектора.
+// EmplaceBack резервирует ячейку одним атомарным fetch_add и не берёт блокировок, чтение по индексу
+// выполняется за ограниченное число шагов без ожидания других потоков
+template <typename T>
+class ConcurrentVector {
+public:
+	static constexpr size_t FIRST_BUCKET_SIZE = 16;
+
+	ConcurrentVector() = default;
+
+	ConcurrentVector(const ConcurrentVector&) = delete;
+	ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+	// Заранее выделяет корзины для первых capacity элементов. Можно вызывать одновременно с EmplaceBack
+	void Reserve(size_t capacity) {
+		if (capacity == 0) {
+			return;
+		}
+		for (size_t bucket = 0; bucket <= BucketIndex(capacity - 1); ++bucket) {
+			GetBucket(bucket);
+		}
+	}
+
+	// Если конструктор T выбросит исключение, зарезервированная ячейка останется пустой:
+	// она учитывается в Size, но TryGet для неё возвращает nullptr
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = GetBucket(BucketIndex(index))[BucketOffset(index)];
+		T* value = new(slot.storage) T(std::forward<Args>(args)...);
+		slot.ready.store(true, std::memory_order_release);
+		return *value;
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	// Число зарезервированных ячеек, включая те, элементы в которых ещё создаются
+	size_t Size() const noexcept {
+		return size_.load(std::memory_order_acquire);
+	}
+
+	// Элемент с индексом index, если он уже создан, иначе nullptr
+	const T* TryGet(size_t index) const noexcept {
+		return const_cast<ConcurrentVector&>(*this).TryGet(index);
+	}
+
+	T* TryGet(size_t index) noexcept {
+		if (index >= Size()) {
+			return nullptr;
+		}
+		Slot* bucket = buckets_[BucketIndex(index)].load(std::memory_order_acquire);
+		if (bucket == nullptr) {
+			return nullptr;
+		}
+		Slot& slot = bucket[BucketOffset(index)];
+		return slot.ready.load(std::memory_order_acquire) ? slot.Get() : nullptr;
+	}
+
+	// Элемент с индексом index должен быть создан, например возвращён из EmplaceBack в этом
+	// или завершённом потоке
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<ConcurrentVector&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		T* value = TryGet(index);
+		assert(value != nullptr);
+		return *value;
+	}
+
+	~ConcurrentVector() {
+		const size_t size = size_.load(std::memory_order_acquire);
+		for (size_t bucket = 0; bucket != BUCKET_COUNT && BucketBegin(bucket) < size; ++bucket) {
+			Slot* slots = storage_[bucket].GetAddress();
+			if (slots == nullptr) {
+				continue;
+			}
+			const size_t count = std::min(BucketSize(bucket), size - BucketBegin(bucket));
+			for (size_t i = 0; i != count; ++i) {
+				if (slots[i].ready.load(std::memory_order_relaxed)) {
+					std::destroy_at(slots[i].Get());
+				}
+			}
+			std::destroy_n(slots, BucketSize(bucket));
+		}
+	}
+
+private:
+	// Ячейка с флагом готовности, который публикует созданный элемент читающим потокам
+	struct Slot {
+		T* Get() noexcept {
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+
+		alignas(T) unsigned char storage[sizeof(T)];
+		std::atomic<bool> ready{ false };
+	};
+
+	static constexpr size_t FloorLog2(size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+		return sizeof(unsigned long long) * CHAR_BIT - 1 - __builtin_clzll(value);
+#else
+		size_t log = 0;
+		while (value >>= 1) {
+			++log;
+		}
+		return log;
+#endif
+	}
+
+	static constexpr size_t FIRST_BUCKET_LOG = FloorLog2(FIRST_BUCKET_SIZE);
+	static_assert(FIRST_BUCKET_SIZE == size_t{1} << FIRST_BUCKET_LOG, "FIRST_BUCKET_SIZE must be a power of two");
+	// Корзин хватает, чтобы адресовать любой индекс size_t
+	static constexpr size_t BUCKET_COUNT = sizeof(size_t) * CHAR_BIT - FIRST_BUCKET_LOG;
+
+	static size_t BucketIndex(size_t index) noexcept {
+		return FloorLog2(index + FIRST_BUCKET_SIZE) - FIRST_BUCKET_LOG;
+	}
+
+	static size_t BucketSize(size_t bucket) noexcept {
+		return FIRST_BUCKET_SIZE << bucket;
+	}
+
+	// Индекс первого элемента корзины
+	static size_t BucketBegin(size_t bucket) noexcept {
+		return BucketSize(bucket) - FIRST_BUCKET_SIZE;
+	}
+
+	static size_t BucketOffset(size_t index) noexcept {
+		return index - BucketBegin(BucketIndex(index));
+	}
+
+	// Возвращает корзину, выделяя её при первом обращении. Если несколько потоков выделили корзину
+	// одновременно, остаётся та, что первой установлена через compare_exchange, а остальные освобождаются
+	Slot* GetBucket(size_t bucket) {
+		Slot* slots = buckets_[bucket].load(std::memory_order_acquire);
+		if (slots != nullptr) {
+			return slots;
+		}
+		RawMemory<Slot> memory(BucketSize(bucket));
+		std::uninitialized_default_construct_n(memory.GetAddress(), BucketSize(bucket));
+		if (buckets_[bucket].compare_exchange_strong(
+				slots, memory.GetAddress(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			// Владельцем буфера становится вектор. Поток, установивший корзину, единственный пишет в storage_[bucket]
+			slots = memory.GetAddress();
+			storage_[bucket] = std::move(memory);
+			return slots;
+		}
+		std::destroy_n(memory.GetAddress(), BucketSize(bucket));
+		return slots;
+	}
+
+	std::atomic<size_t> size_{ 0 };
+	std::atomic<Slot*> buckets_[BUCKET_COUNT] = {};
+	RawMemory<Slot> storage_[BUCKET_COUNT];
+};
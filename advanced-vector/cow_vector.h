@@ -0,0 +1,231 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+// Вектор с общим буфером и копированием при записи. Копия CowVector лишь увеличивает счётчик ссылок
+// на буфер, а первый изменяющий вызов (неконстантный operator[], begin/end, PushBack, Erase и т.д.)
+// создаёт собственную копию элементов, если буфер используется кем-то ещё. Счётчик атомарный,
+// поэтому копии можно передавать в другие потоки и читать там одновременно; сам объект CowVector,
+// как и Vector, нельзя одновременно изменять из нескольких потоков.
+// Ссылки и итераторы, полученные до отделения буфера, указывают на общие элементы
+template <typename T>
+class CowVector {
+public:
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	CowVector() = default;
+
+	explicit CowVector(size_t size)
+		: CowVector(Vector<T>(size)) {
+	}
+
+	explicit CowVector(Vector<T>&& data)
+		: buffer_(new Buffer{ std::move(data) }) {
+	}
+
+	CowVector(const CowVector& other) noexcept
+		: buffer_(other.buffer_) {
+		if (buffer_ != nullptr) {
+			buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	CowVector(CowVector&& other) noexcept
+		: buffer_(std::exchange(other.buffer_, nullptr)) {
+	}
+
+	CowVector& operator=(const CowVector& rhs) noexcept {
+		CowVector rhs_copy(rhs);
+		Swap(rhs_copy);
+		return *this;
+	}
+
+	CowVector& operator=(CowVector&& rhs) noexcept {
+		CowVector rhs_copy(std::move(rhs));
+		Swap(rhs_copy);
+		return *this;
+	}
+
+	~CowVector() {
+		Unref();
+	}
+
+	void Swap(CowVector& other) noexcept {
+		std::swap(buffer_, other.buffer_);
+	}
+
+	const_iterator begin() const noexcept {
+		return Get().begin();
+	}
+
+	const_iterator end() const noexcept {
+		return Get().end();
+	}
+
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	iterator begin() {
+		return Mutable().begin();
+	}
+
+	iterator end() {
+		return Mutable().end();
+	}
+
+	size_t Size() const noexcept {
+		return Get().Size();
+	}
+
+	size_t Capacity() const noexcept {
+		return Get().Capacity();
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return Get()[index];
+	}
+
+	T& operator[](size_t index) {
+		return Mutable()[index];
+	}
+
+	// Элементы только для чтения, без отделения буфера
+	const Vector<T>& Get() const noexcept {
+		static const Vector<T> empty;
+		return buffer_ != nullptr ? buffer_->data : empty;
+	}
+
+	// Собственный буфер для изменения. Если буфер общий, элементы копируются
+	Vector<T>& Mutable() {
+		if (buffer_ == nullptr) {
+			buffer_ = new Buffer;
+		}
+		else if (IsShared()) {
+			Detach(Size(), Size());
+		}
+		return buffer_->data;
+	}
+
+	// Разделяет ли буфер ещё хотя бы один CowVector
+	bool IsShared() const noexcept {
+		return UseCount() > 1;
+	}
+
+	// Сколько CowVector ссылаются на буфер, 0 для пустого вектора без буфера
+	size_t UseCount() const noexcept {
+		// acquire-чтение согласовано с release-уменьшением в Unref: если счётчик равен 1, все изменения
+		// и чтения буфера через освободившиеся копии завершены, и его можно изменять
+		return buffer_ != nullptr ? buffer_->refs.load(std::memory_order_acquire) : 0;
+	}
+
+	void Reserve(size_t new_capacity) {
+		if (IsShared()) {
+			Detach(Size(), new_capacity);
+		}
+		Mutable().Reserve(new_capacity);
+	}
+
+	void Resize(size_t new_size) {
+		if (IsShared()) {
+			// Копируются только элементы, остающиеся в векторе
+			Detach(std::min(new_size, Size()), new_size);
+		}
+		Mutable().Resize(new_size);
+	}
+
+	// Не копирует элементы общего буфера, а просто отказывается от него
+	void Clear() noexcept {
+		if (IsShared()) {
+			CowVector().Swap(*this);
+		}
+		else if (buffer_ != nullptr) {
+			buffer_->data.Clear();
+		}
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		if (IsShared()) {
+			// Копия сразу получает место под новый элемент, чтобы не переносить элементы повторно
+			Detach(Size(), std::max(Size() + 1, Capacity()));
+		}
+		return Mutable().EmplaceBack(std::forward<Args>(args)...);
+	}
+
+	void PopBack() {
+		Mutable().PopBack();
+	}
+
+	// pos может быть получен как из константного, так и из неконстантного begin: после отделения
+	// буфера он пересчитывается по индексу
+	iterator Erase(const_iterator pos) {
+		const size_t index = pos - Get().begin();
+		Vector<T>& data = Mutable();
+		return data.Erase(data.begin() + index);
+	}
+
+	iterator Erase(const_iterator first, const_iterator last) {
+		const size_t index = first - Get().begin();
+		const size_t count = last - first;
+		Vector<T>& data = Mutable();
+		return data.Erase(data.begin() + index, data.begin() + index + count);
+	}
+
+	iterator Insert(const_iterator pos, const T& value) {
+		return Emplace(pos, value);
+	}
+
+	iterator Insert(const_iterator pos, T&& value) {
+		return Emplace(pos, std::move(value));
+	}
+
+	template <typename... Args>
+	iterator Emplace(const_iterator pos, Args&&... args) {
+		const size_t index = pos - Get().begin();
+		Vector<T>& data = Mutable();
+		return data.Emplace(data.begin() + index, std::forward<Args>(args)...);
+	}
+
+private:
+	struct Buffer {
+		Vector<T> data;
+		std::atomic<size_t> refs{ 1 };
+	};
+
+	// Заменяет общий буфер собственным с копией первых count элементов и вместимостью не меньше capacity.
+	// Если копирование выбросит исключение, вектор остаётся прежним
+	void Detach(size_t count, size_t capacity) {
+		Vector<T> copy;
+		copy.Reserve(std::max(count, capacity));
+		copy.Append(Get().begin(), Get().begin() + count);
+		Buffer* buffer = new Buffer{ std::move(copy) };
+		Unref();
+		buffer_ = buffer;
+	}
+
+	void Unref() noexcept {
+		if (buffer_ != nullptr && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete buffer_;
+		}
+		buffer_ = nullptr;
+	}
+
+	Buffer* buffer_ = nullptr;
+};
@@ -0,0 +1,419 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace flat_detail {
+
+// Первый элемент диапазона [first, first + size), ключ которого не меньше key. Вместо ветвления на каждом шаге
+// выбирается одна из двух границ, что компилятор превращает в условную пересылку: такой поиск не страдает
+// от непредсказуемых переходов, а обращения к памяти на всех шагах известны заранее
+template <typename Value, typename Key, typename KeyOf, typename Compare>
+Value* BranchlessLowerBound(Value* first, size_t size, const Key& key, const KeyOf& key_of, const Compare& comp) {
+	if (size == 0) {
+		return first;
+	}
+	while (size > 1) {
+		const size_t half = size / 2;
+		first = comp(key_of(first[half - 1]), key) ? first + half : first;
+		size -= half;
+	}
+	return first + (comp(key_of(*first), key) ? 1 : 0);
+}
+
+struct Identity {
+	template <typename T>
+	const T& operator()(const T& value) const noexcept {
+		return value;
+	}
+};
+
+struct PairFirst {
+	template <typename Pair>
+	const auto& operator()(const Pair& value) const noexcept {
+		return value.first;
+	}
+};
+
+// Итератор FlatMap, через который можно менять значения, но не ключи: разыменование даёт пару ссылок
+// pair<const Key&, T&>, а не ссылку на хранимую пару, изменение ключа которой нарушило бы порядок.
+// Неявно преобразуется в const_iterator
+template <typename Key, typename T>
+class PairRefIterator {
+	using Pair = std::pair<Key, T>;
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = Pair;
+	using difference_type = std::ptrdiff_t;
+	using reference = std::pair<const Key&, T&>;
+
+	// operator-> возвращает временную пару ссылок
+	struct pointer {
+		const reference* operator->() const noexcept {
+			return &value;
+		}
+
+		reference value;
+	};
+
+	PairRefIterator() = default;
+
+	explicit PairRefIterator(Pair* pos) noexcept
+		: pos_(pos) {
+	}
+
+	operator const Pair*() const noexcept {
+		return pos_;
+	}
+
+	reference operator*() const noexcept {
+		return { pos_->first, pos_->second };
+	}
+	pointer operator->() const noexcept {
+		return { **this };
+	}
+	reference operator[](difference_type offset) const noexcept {
+		return *(*this + offset);
+	}
+
+	PairRefIterator& operator++() noexcept {
+		++pos_;
+		return *this;
+	}
+	PairRefIterator operator++(int) noexcept {
+		return PairRefIterator(pos_++);
+	}
+	PairRefIterator& operator--() noexcept {
+		--pos_;
+		return *this;
+	}
+	PairRefIterator operator--(int) noexcept {
+		return PairRefIterator(pos_--);
+	}
+	PairRefIterator& operator+=(difference_type offset) noexcept {
+		pos_ += offset;
+		return *this;
+	}
+	PairRefIterator& operator-=(difference_type offset) noexcept {
+		pos_ -= offset;
+		return *this;
+	}
+	friend PairRefIterator operator+(PairRefIterator it, difference_type offset) noexcept {
+		return it += offset;
+	}
+	friend PairRefIterator operator+(difference_type offset, PairRefIterator it) noexcept {
+		return it += offset;
+	}
+	friend PairRefIterator operator-(PairRefIterator it, difference_type offset) noexcept {
+		return it -= offset;
+	}
+	friend difference_type operator-(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return lhs.pos_ - rhs.pos_;
+	}
+
+	friend bool operator==(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return lhs.pos_ == rhs.pos_;
+	}
+	friend bool operator!=(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return lhs.pos_ != rhs.pos_;
+	}
+	friend bool operator<(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return lhs.pos_ < rhs.pos_;
+	}
+	friend bool operator>(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return rhs < lhs;
+	}
+	friend bool operator<=(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return !(rhs < lhs);
+	}
+	friend bool operator>=(const PairRefIterator& lhs, const PairRefIterator& rhs) noexcept {
+		return !(lhs < rhs);
+	}
+
+private:
+	Pair* pos_ = nullptr;
+};
+
+// Упорядоченный по ключу вектор уникальных элементов — общая часть FlatSet и FlatMap.
+// KeyOf извлекает ключ из элемента
+template <typename Value, typename Key, typename KeyOf, typename Compare>
+class SortedVector {
+public:
+	using iterator = Value*;
+	using const_iterator = const Value*;
+
+	SortedVector() = default;
+
+	explicit SortedVector(const Compare& comp)
+		: comp_(comp) {
+	}
+
+	// Элементы сортируются, из равных по ключу остаётся первый
+	explicit SortedVector(Vector<Value>&& values, const Compare& comp = Compare())
+		: comp_(comp) {
+		InsertBulk(std::move(values));
+	}
+
+	const_iterator begin() const noexcept {
+		return elements_.begin();
+	}
+	const_iterator end() const noexcept {
+		return elements_.end();
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	size_t Size() const noexcept {
+		return elements_.Size();
+	}
+
+	size_t Capacity() const noexcept {
+		return elements_.Capacity();
+	}
+
+	void Reserve(size_t new_capacity) {
+		elements_.Reserve(new_capacity);
+	}
+
+	void ShrinkToFit() {
+		elements_.ShrinkToFit();
+	}
+
+	void Clear() noexcept {
+		elements_.Clear();
+	}
+
+	// Элементы в порядке ключей
+	const Vector<Value>& Elements() const noexcept {
+		return elements_;
+	}
+
+	const_iterator LowerBound(const Key& key) const noexcept {
+		return BranchlessLowerBound(elements_.Data(), elements_.Size(), key, KeyOf(), GetCompare());
+	}
+
+	const_iterator UpperBound(const Key& key) const noexcept {
+		return std::upper_bound(begin(), end(), key, [this](const Key& lhs, const Value& rhs) {
+			return GetCompare()(lhs, KeyOf()(rhs));
+		});
+	}
+
+	const_iterator Find(const Key& key) const noexcept {
+		const_iterator pos = LowerBound(key);
+		return pos != end() && !GetCompare()(key, KeyOf()(*pos)) ? pos : end();
+	}
+
+	bool Contains(const Key& key) const noexcept {
+		return Find(key) != end();
+	}
+
+	size_t Count(const Key& key) const noexcept {
+		return Contains(key) ? 1 : 0;
+	}
+
+	// Удаляет элемент с ключом key и возвращает количество удалённых элементов
+	size_t Erase(const Key& key) {
+		const const_iterator pos = Find(key);
+		if (pos == end()) {
+			return 0;
+		}
+		elements_.Erase(pos);
+		return 1;
+	}
+
+	const_iterator Erase(const_iterator pos) {
+		return elements_.Erase(pos);
+	}
+
+	const_iterator Erase(const_iterator first, const_iterator last) {
+		return elements_.Erase(first, last);
+	}
+
+	// Пакетная вставка: новые элементы дописываются в конец, сортируются и сливаются с существующими
+	// за O(n + m log m) вместо O(n * m) последовательных вставок. Элементы с уже имеющимися ключами
+	// не вставляются, из равных по ключу новых остаётся первый
+	template <typename InputIt>
+	void InsertBulk(InputIt first, InputIt last) {
+		const size_t old_size = elements_.Size();
+		elements_.Append(first, last);
+		MergeTail(old_size);
+	}
+
+	void InsertBulk(Vector<Value>&& values) {
+		if (elements_.Size() == 0) {
+			elements_ = std::move(values);
+			MergeTail(0);
+			return;
+		}
+		const size_t old_size = elements_.Size();
+		elements_.Append(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+		MergeTail(old_size);
+	}
+
+protected:
+	const Compare& GetCompare() const noexcept {
+		return comp_;
+	}
+
+	iterator MutableBegin() noexcept {
+		return elements_.begin();
+	}
+
+	// Вставляет элемент, созданный из args, перед pos, если ключ key ещё не встречается.
+	// Последующие элементы сдвигаются через перенос Vector::Emplace: для побайтово переносимых типов — memmove
+	template <typename... Args>
+	std::pair<iterator, bool> EmplaceUnique(const Key& key, Args&&... args) {
+		const size_t index = LowerBound(key) - begin();
+		if (index == Size()) {
+			return { &elements_.EmplaceBack(std::forward<Args>(args)...), true };
+		}
+		if (!GetCompare()(key, KeyOf()(elements_[index]))) {
+			return { elements_.begin() + index, false };
+		}
+		// Аргументы могут ссылаться на элементы (в том числе через кортежи piecewise_construct, которые
+		// Vector::Emplace не распознаёт), поэтому элемент создаётся до сдвига хвоста
+		Value value(std::forward<Args>(args)...);
+		return { elements_.Emplace(elements_.begin() + index, std::move(value)), true };
+	}
+
+private:
+	// Упорядочивает элементы [old_size, Size()) и сливает их с упорядоченными [0, old_size)
+	void MergeTail(size_t old_size) {
+		const auto less = [this](const Value& lhs, const Value& rhs) {
+			return GetCompare()(KeyOf()(lhs), KeyOf()(rhs));
+		};
+		const iterator first = elements_.begin();
+		const iterator middle = first + old_size;
+		// Устойчивые сортировка и слияние ставят первым из равных элемент, пришедший раньше
+		std::stable_sort(middle, elements_.end(), less);
+		std::inplace_merge(first, middle, elements_.end(), less);
+		const iterator new_end = std::unique(first, elements_.end(), [&less](const Value& lhs, const Value& rhs) {
+			return !less(lhs, rhs);
+		});
+		elements_.Erase(new_end, elements_.end());
+	}
+
+	Vector<Value> elements_;
+	// Сравнение хранится членом, а не базовым классом, чтобы подходили и указатели на функции
+	Compare comp_ = Compare();
+};
+
+}  // namespace flat_detail
+
+// Множество уникальных ключей в упорядоченном Vector. Поиск — двоичный без ветвлений по непрерывной памяти,
+// поэтому для небольших и редко меняющихся наборов он быстрее std::set, обходящего узлы по указателям.
+// Вставка и удаление одиночного элемента стоят O(n), для заполнения следует использовать InsertBulk.
+// Итераторы становятся недействительными при любом изменении
+template <typename Key, typename Compare = std::less<Key>>
+class FlatSet : public flat_detail::SortedVector<Key, Key, flat_detail::Identity, Compare> {
+	using Base = flat_detail::SortedVector<Key, Key, flat_detail::Identity, Compare>;
+
+public:
+	using Base::Base;
+
+	FlatSet() = default;
+
+	FlatSet(std::initializer_list<Key> keys, const Compare& comp = Compare())
+		: Base(comp) {
+		Base::InsertBulk(keys.begin(), keys.end());
+	}
+
+	std::pair<typename Base::const_iterator, bool> Insert(const Key& key) {
+		return Base::EmplaceUnique(key, key);
+	}
+
+	std::pair<typename Base::const_iterator, bool> Insert(Key&& key) {
+		return Base::EmplaceUnique(key, std::move(key));
+	}
+};
+
+// Ассоциативный массив в упорядоченном Vector пар ключ-значение, аналог std::map для таблиц поиска,
+// которые заполняются один раз и затем в основном читаются. Ключи элементов изменять нельзя: неконстантный
+// итератор даёт доступ к ключу только для чтения
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class FlatMap : public flat_detail::SortedVector<std::pair<Key, T>, Key, flat_detail::PairFirst, Compare> {
+	using Base = flat_detail::SortedVector<std::pair<Key, T>, Key, flat_detail::PairFirst, Compare>;
+
+public:
+	using value_type = std::pair<Key, T>;
+	using iterator = flat_detail::PairRefIterator<Key, T>;
+	using const_iterator = typename Base::const_iterator;
+	using Base::Base;
+	using Base::begin;
+	using Base::end;
+	using Base::Find;
+
+	FlatMap() = default;
+
+	FlatMap(std::initializer_list<value_type> values, const Compare& comp = Compare())
+		: Base(comp) {
+		Base::InsertBulk(values.begin(), values.end());
+	}
+
+	iterator begin() noexcept {
+		return iterator(Base::MutableBegin());
+	}
+	iterator end() noexcept {
+		return iterator(Base::MutableBegin() + Base::Size());
+	}
+
+	iterator Find(const Key& key) noexcept {
+		return begin() + (std::as_const(*this).Find(key) - Base::begin());
+	}
+
+	const T& At(const Key& key) const {
+		const const_iterator pos = Find(key);
+		if (pos == end()) {
+			throw std::out_of_range("FlatMap key not found");
+		}
+		return pos->second;
+	}
+
+	T& At(const Key& key) {
+		return const_cast<T&>(std::as_const(*this).At(key));
+	}
+
+	// Значение по ключу; если ключа нет, вставляется значение по умолчанию
+	T& operator[](const Key& key) {
+		return TryEmplace(key).first->second;
+	}
+
+	std::pair<iterator, bool> Insert(const value_type& value) {
+		return Wrap(Base::EmplaceUnique(value.first, value));
+	}
+
+	std::pair<iterator, bool> Insert(value_type&& value) {
+		return Wrap(Base::EmplaceUnique(value.first, std::move(value)));
+	}
+
+	// Создаёт значение из args, только если ключа ещё нет
+	template <typename... Args>
+	std::pair<iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+		return Wrap(Base::EmplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(std::forward<Args>(args)...)));
+	}
+
+	template <typename M>
+	std::pair<iterator, bool> InsertOrAssign(const Key& key, M&& value) {
+		auto result = TryEmplace(key, std::forward<M>(value));
+		if (!result.second) {
+			result.first->second = std::forward<M>(value);
+		}
+		return result;
+	}
+
+private:
+	static std::pair<iterator, bool> Wrap(std::pair<typename Base::iterator, bool> result) noexcept {
+		return { iterator(result.first), result.second };
+	}
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include "vector.h"
+
+// Вектор с постепенным переносом элементов при росте. Когда вместимость исчерпана, выделяется буфер
+// вдвое большего размера, но старые элементы остаются в прежнем буфере и переносятся по MigrationStep
+// штук за каждое следующее добавление, поэтому ни один вызов EmplaceBack не переносит все элементы сразу.
+// Пока перенос не завершён, обращение по индексу направляется в тот буфер, где лежит элемент:
+// элементы [0, old_size_) ещё находятся в старом буфере, остальные — уже в новом, на тех же позициях.
+// После роста с вместимости c перенос занимает ceil(c / MigrationStep) добавлений, то есть завершается,
+// когда новый буфер заполнен на (1 + 1 / MigrationStep) / 2: при MigrationStep = 2 — на три четверти.
+// Ссылки на элементы, как и у Vector, становятся недействительными при добавлении
+template <typename T, size_t MigrationStep = 2>
+class IncrementalVector {
+	static_assert(MigrationStep > 0, "Migration must make progress");
+
+public:
+	IncrementalVector() = default;
+
+	explicit IncrementalVector(size_t size)
+		: data_(size) {
+		std::uninitialized_value_construct_n(data_.GetAddress(), size);
+		size_ = size;
+	}
+
+	IncrementalVector(const IncrementalVector& other)
+		: data_(other.size_) {
+		for (; size_ != other.size_; ++size_) {
+			try {
+				new(data_ + size_) T(other[size_]);
+			}
+			catch (...) {
+				std::destroy_n(data_.GetAddress(), size_);
+				throw;
+			}
+		}
+	}
+
+	IncrementalVector(IncrementalVector&& other) noexcept {
+		Swap(other);
+	}
+
+	IncrementalVector& operator=(const IncrementalVector& rhs) {
+		if (this != &rhs) {
+			IncrementalVector rhs_copy(rhs);
+			Swap(rhs_copy);
+		}
+		return *this;
+	}
+
+	IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+		if (this != &rhs) {
+			Clear();
+			Swap(rhs);
+		}
+		return *this;
+	}
+
+	void Swap(IncrementalVector& other) noexcept {
+		data_.Swap(other.data_);
+		old_.Swap(other.old_);
+		std::swap(size_, other.size_);
+		std::swap(old_size_, other.old_size_);
+	}
+
+	// Переносит оставшиеся элементы сразу, после чего все элементы лежат в одном буфере
+	void FinishMigration() {
+		while (IsMigrating()) {
+			MigrateStep(old_size_);
+		}
+	}
+
+	// Идёт ли перенос элементов из старого буфера
+	bool IsMigrating() const noexcept {
+		return old_size_ != 0;
+	}
+
+	// Выделяет буфер сразу под new_capacity элементов
+	void Reserve(size_t new_capacity) {
+		if (new_capacity <= data_.Capacity()) {
+			return;
+		}
+		FinishMigration();
+		RawMemory<T> new_data(new_capacity);
+		RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+		data_.Swap(new_data);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return data_.Capacity();
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<IncrementalVector&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return index < old_size_ ? old_[index] : data_[index];
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	// Выполняется за O(MigrationStep) плюс время выделения буфера при росте
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		if (size_ == data_.Capacity()) {
+			Grow();
+		}
+		// Элемент создаётся до переноса, так как аргументы могут ссылаться на переносимые элементы
+		T* elem_pointer = new(data_ + size_) T(std::forward<Args>(args)...);
+		if (IsMigrating()) {
+			try {
+				MigrateStep(MigrationStep);
+			}
+			catch (...) {
+				std::destroy_at(elem_pointer);
+				throw;
+			}
+		}
+		++size_;
+		return *elem_pointer;
+	}
+
+	void PopBack() noexcept {
+		assert(size_ != 0);
+		std::destroy_at(&(*this)[size_ - 1]);
+		--size_;
+		old_size_ = std::min(old_size_, size_);
+		if (!IsMigrating()) {
+			old_ = RawMemory<T>();
+		}
+	}
+
+	void Clear() noexcept {
+		while (size_ != 0) {
+			PopBack();
+		}
+	}
+
+	~IncrementalVector() {
+		std::destroy_n(old_.GetAddress(), old_size_);
+		std::destroy_n(data_ + old_size_, size_ - old_size_);
+	}
+
+private:
+	// Прежний буфер остаётся старым, пока из него не перенесены все элементы, а новый выделяется вдвое большим
+	void Grow() {
+		FinishMigration();
+		RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+		old_.Swap(data_);
+		data_.Swap(new_data);
+		old_size_ = size_;
+	}
+
+	// Переносит до count последних элементов старого буфера на те же позиции в новом.
+	// Если перенос элемента выбросит исключение, он остаётся в старом буфере
+	void MigrateStep(size_t count) {
+		count = std::min(count, old_size_);
+		const size_t first = old_size_ - count;
+		RelocateN(old_ + first, count, data_ + first);
+		old_size_ = first;
+		if (!IsMigrating()) {
+			old_ = RawMemory<T>();
+		}
+	}
+
+	RawMemory<T> data_;
+	// Буфер, из которого ещё не перенесены первые old_size_ элементов
+	RawMemory<T> old_;
+	size_t size_ = 0;
+	size_t old_size_ = 0;
+};
@@ -1,8 +1,37 @@
 #include "vector.h"
+#include "aligned_allocator.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "incremental_vector.h"
+#include "malloc_allocator.h"
+#if __has_include(<sys/mman.h>)
+#include "mmap_vector.h"
+#define VECTOR_TEST_MMAP
+#endif
+#include "numa_allocator.h"
+#include "parallel_vector.h"
+#include "pool_allocator.h"
+#include "serialization.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "stable_vector.h"
+#include "static_vector.h"
+#include "vector_algorithms.h"
 
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
 
 namespace {
 
@@ -98,8 +127,117 @@ struct Obj {
     static inline int num_destroyed = 0;
 };
 
+// Аналог Obj для параллельных тестов: счётчик живых объектов атомарный
+struct SharedObj {
+    SharedObj() {
+        if (default_construction_throw_countdown > 0 && default_construction_throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    SharedObj(const SharedObj& other)
+        : id(other.id) {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    SharedObj& operator=(const SharedObj& other) = default;
+
+    ~SharedObj() {
+        --num_alive;
+    }
+
+    bool throw_on_copy = false;
+    int id = 0;
+
+    static inline std::atomic<int> default_construction_throw_countdown = 0;
+    static inline std::atomic<int> num_alive = 0;
+};
+
+// Тип с нетривиальным перемещением, который объявлен побайтово переносимым
+struct RelocatableObj {
+    RelocatableObj() = default;
+    explicit RelocatableObj(int id)
+        : id(id) {
+    }
+    RelocatableObj(const RelocatableObj& other)
+        : id(other.id) {
+        ++num_copied;
+    }
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(other.id) {
+        ++num_moved;
+    }
+    RelocatableObj& operator=(const RelocatableObj& other) = default;
+    RelocatableObj& operator=(RelocatableObj&& other) = default;
+    ~RelocatableObj() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Аллокатор, ведущий учёт выделенных байт. Аллокаторы с разными id не равны
+// и не передаются при перемещающем присваивании
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::false_type;
+
+    CountingAllocator(size_t* allocated_bytes, int id)
+        : allocated_bytes(allocated_bytes)
+        , id(id) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other)
+        : allocated_bytes(other.allocated_bytes)
+        , id(other.id) {
+    }
+
+    T* allocate(size_t n) {
+        *allocated_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        *allocated_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return id == other.id;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return id != other.id;
+    }
+
+    size_t* allocated_bytes;
+    int id;
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -380,6 +518,1836 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const size_t SIZE = 100;
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (size_t i = 0; i != SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        v.Insert(v.begin() + 1, RelocatableObj{-1});
+        v.Erase(v.begin());
+        assert(v.Size() == SIZE);
+        assert(v[0].id == -1);
+        assert(v[1].id == 1);
+        assert(v[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        assert(RelocatableObj::num_copied == 0);
+        // Перенос элементов при росте, вставке и удалении не вызывает конструкторов
+        const int num_moved = RelocatableObj::num_moved;
+        v.Reserve(SIZE * 8);
+        v.Erase(v.begin() + SIZE / 2);
+        assert(RelocatableObj::num_moved == num_moved);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i != static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Emplace(v.begin(), std::make_unique<int>(-1));
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == SIZE);
+        assert(*v[0] == -1);
+        assert(*v[1] == 1);
+        assert(*v[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+}
+
+void Test7() {
+    const size_t SIZE = 100;
+    size_t first_bytes = 0;
+    size_t second_bytes = 0;
+    {
+        Obj::ResetCounters();
+        using Alloc = CountingAllocator<Obj>;
+        Vector<Obj, Alloc> v(SIZE, Alloc(&first_bytes, 1));
+        assert(first_bytes == SIZE * sizeof(Obj));
+        v.PushBack(Obj{});
+        assert(first_bytes == SIZE * 2 * sizeof(Obj));
+
+        Vector<Obj, Alloc> v_copy(v);
+        assert(v_copy.GetAllocator() == v.GetAllocator());
+        assert(first_bytes == (SIZE * 2 + SIZE + 1) * sizeof(Obj));
+
+        // Аллокаторы не равны и не передаются, поэтому элементы перемещаются в память второго аллокатора
+        Vector<Obj, Alloc> other(Alloc(&second_bytes, 2));
+        other = std::move(v_copy);
+        assert(other.GetAllocator().id == 2);
+        assert(other.Size() == SIZE + 1);
+        assert(second_bytes == (SIZE + 1) * sizeof(Obj));
+
+        // Равные аллокаторы позволяют забрать буфер без перемещения элементов
+        const int num_moved = Obj::num_moved;
+        Vector<Obj, Alloc> same(Alloc(&first_bytes, 1));
+        same = std::move(v);
+        assert(Obj::num_moved == num_moved);
+        assert(same.Size() == SIZE + 1);
+    }
+    assert(first_bytes == 0);
+    assert(second_bytes == 0);
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test8() {
+    const size_t SIZE = 100'500;
+    {
+        Vector<double, MallocAllocator<double>> v;
+        for (size_t i = 0; i != SIZE; ++i) {
+            v.PushBack(static_cast<double>(i));
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() >= SIZE);
+        // Излишек памяти, выделенный аллокатором, используется как дополнительная вместимость
+        v.Reserve(SIZE * 3);
+        assert(v.Capacity() >= SIZE * 3);
+        v.Insert(v.begin(), v[SIZE - 1]);
+        v.Erase(v.begin() + 1);
+        assert(v[0] == static_cast<double>(SIZE - 1));
+        for (size_t i = 1; i != SIZE; ++i) {
+            assert(v[i] == static_cast<double>(i));
+        }
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(1);
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(0);
+        }
+        // Аргумент ссылается на элемент вектора, буфер которого будет перевыделен через realloc
+        v.PushBack(v[0]);
+        v.Insert(v.begin() + 1, v[0]);
+        assert(v[v.Size() - 1] == 0);
+        assert(v[1] == 0);
+    }
+    {
+        // Размер, переполняющий size_t в байтах, отвергается, а не превращается в маленький блок
+        const size_t too_many = std::numeric_limits<size_t>::max() / sizeof(uint64_t) + 2;
+        bool thrown = false;
+        try {
+            Vector<uint64_t, MallocAllocator<uint64_t>> v(too_many);
+        } catch (const std::bad_array_new_length&) {
+            thrown = true;
+        }
+        assert(thrown);
+        Vector<uint64_t, MallocAllocator<uint64_t>> v(4);
+        thrown = false;
+        try {
+            v.Reserve(too_many);
+        } catch (const std::bad_array_new_length&) {
+            thrown = true;
+        }
+        assert(thrown && v.Size() == 4 && v.Capacity() >= 4);
+    }
+}
+
+void Test9() {
+    const size_t INLINE_SIZE = 8;
+    const int ID = 42;
+    using SmallObjVector = SmallVector<Obj, INLINE_SIZE>;
+    {
+        Obj::ResetCounters();
+        SmallObjVector v;
+        for (size_t i = 0; i != INLINE_SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(v.Capacity() == INLINE_SIZE);
+        const auto* object_begin = reinterpret_cast<const char*>(&v);
+        const auto* elem = reinterpret_cast<const char*>(&v[0]);
+        assert(elem >= object_begin && elem < object_begin + sizeof(v));
+
+        v.Insert(v.begin(), v[INLINE_SIZE - 1]);
+        assert(!v.IsInline());
+        assert(v.Capacity() == INLINE_SIZE * 2);
+        assert(v[0].id == static_cast<int>(INLINE_SIZE - 1));
+        assert(v[1].id == 0);
+        v.Erase(v.begin());
+        assert(v.Size() == INLINE_SIZE);
+
+        SmallObjVector moved(std::move(v));
+        assert(moved.Size() == INLINE_SIZE);
+        assert(v.Size() == 0);
+        SmallObjVector copy(moved);
+        assert(copy.IsInline());
+        assert(copy[INLINE_SIZE - 1].id == static_cast<int>(INLINE_SIZE - 1));
+        copy.Swap(moved);
+        assert(!copy.IsInline());
+        assert(moved.IsInline());
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = INLINE_SIZE / 2;
+        try {
+            SmallObjVector v(INLINE_SIZE);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        SmallObjVector v(INLINE_SIZE * 2);
+        v[INLINE_SIZE].throw_on_copy = true;
+        try {
+            SmallObjVector v_copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+            assert(Obj::num_copied == static_cast<int>(INLINE_SIZE));
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(INLINE_SIZE * 2));
+    }
+    {
+        SmallVector<TestObj, 1> v(1);
+        // Добавление элемента самого вектора безопасно и при переходе из встроенного буфера в кучу
+        v.PushBack(v[0]);
+        v.EmplaceBack(std::move(v[1]));
+        assert(v[0].IsAlive());
+        assert(v[2].IsAlive());
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, 2> v;
+        v.EmplaceBack(ID);
+        v.PopBack();
+        assert(v.Size() == 0);
+        assert(v.IsInline());
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test10() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i != SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), "obj"s);
+        }
+        // Элементы создаются сразу на своём месте, без промежуточных перемещений
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_constructed_with_id_and_name == static_cast<int>(SIZE));
+
+        v.Emplace(v.begin() + 1, ID, "Ivan"s);
+        assert(Obj::num_constructed_with_id_and_name == static_cast<int>(SIZE + 1));
+        // Перемещающий конструктор вызывается лишь для последнего элемента, переезжающего в свободную ячейку
+        assert(Obj::num_moved == 1);
+        assert(v[1].id == ID);
+        assert(v[1].name == "Ivan"s);
+        assert(v[SIZE].id == static_cast<int>(SIZE - 1));
+
+        const int num_moved = Obj::num_moved;
+        const int num_copied = Obj::num_copied;
+        v.Insert(v.begin(), v[SIZE]);
+        assert(v[0].id == static_cast<int>(SIZE - 1));
+        assert(v[SIZE + 1].id == static_cast<int>(SIZE - 1));
+        // Аргумент ссылается на элемент вектора, поэтому копия создаётся во временном объекте и затем перемещается
+        assert(Obj::num_copied == num_copied + 1);
+        assert(Obj::num_moved == num_moved + 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Emplace(v.begin() + SIZE / 2, ID);
+        // При реаллокации элемент создаётся прямо в новом буфере, а старые элементы переезжают по одному разу
+        assert(Obj::num_moved == static_cast<int>(SIZE));
+        assert(v[SIZE / 2].id == ID);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<TestObj> v(2);
+        v.Reserve(4);
+        // Вставка существующего элемента вектора безопасна и без реаллокации памяти
+        v.Emplace(v.begin(), v[1]);
+        v.Emplace(v.begin(), std::move(v[2]));
+        assert(v[0].IsAlive());
+        assert(v[1].IsAlive());
+        assert(v[3].IsAlive());
+    }
+}
+
+void Test11() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        const size_t EXPECTED_CAPACITIES[] = {1, 2, 3, 4, 6, 9, 13, 19};
+        for (size_t expected_capacity : EXPECTED_CAPACITIES) {
+            v.PushBack(0);
+            assert(v.Capacity() == expected_capacity);
+            while (v.Size() != v.Capacity()) {
+                v.PushBack(0);
+            }
+        }
+    }
+    {
+        assert(SizeClassGrowth::RoundToSizeClass(1) == 16);
+        assert(SizeClassGrowth::RoundToSizeClass(100) == 112);
+        assert(SizeClassGrowth::RoundToSizeClass(4096) == 4096);
+        assert(SizeClassGrowth::RoundToSizeClass(4097) == 5120);
+        Vector<char, std::allocator<char>, SizeClassGrowth> v;
+        v.PushBack('a');
+        assert(v.Capacity() == 16);
+    }
+    {
+        const size_t HUGE_PAGE_DOUBLES = HugePageGrowth::HUGE_PAGE_SIZE / sizeof(double);
+        assert(HugePageGrowth::NextCapacity(10, 11, sizeof(double)) == 20);
+        assert(HugePageGrowth::NextCapacity(HUGE_PAGE_DOUBLES / 2 + 1, HUGE_PAGE_DOUBLES / 2 + 2, sizeof(double))
+               == HUGE_PAGE_DOUBLES * 2);
+        Vector<double, std::allocator<double>, HugePageGrowth> v(HUGE_PAGE_DOUBLES - 1);
+        v.PushBack(1.0);
+        v.PushBack(2.0);
+        assert(v.Capacity() == HUGE_PAGE_DOUBLES * 2);
+        assert(v[HUGE_PAGE_DOUBLES] == 2.0);
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v;
+        const int values[] = {1, 2, 3, 4, 5};
+        v.Append(std::begin(values), std::end(values));
+        assert(v.Size() == 5);
+        assert(v.Capacity() == 5);
+        v.Insert(v.begin() + 1, std::begin(values), std::begin(values) + 2);
+        v.Insert(v.begin(), 3, 7);
+        v.Insert(v.end(), 1, v[0]);
+        v.Append(2, v[3]);
+        const int expected[] = {7, 7, 7, 1, 1, 2, 2, 3, 4, 5, 7, 1, 1};
+        assert(v.Size() == std::size(expected));
+        assert(std::equal(v.begin(), v.end(), std::begin(expected)));
+
+        std::istringstream input("10 20 30");
+        v.Insert(v.begin() + 2, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v[1] == 7);
+        assert(v[2] == 10);
+        assert(v[4] == 30);
+        assert(v[5] == 7);
+
+        v.Assign(3, v[2]);
+        assert(v.Size() == 3);
+        assert(v[0] == 10 && v[2] == 10);
+        const std::list<int> source = {4, 5};
+        v.Assign(source.begin(), source.end());
+        assert(v.Size() == 2);
+        assert(v[0] == 4 && v[1] == 5);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 3);
+        const std::list<Obj> source(SIZE / 2);
+        const int num_moved = Obj::num_moved;
+        v.Insert(v.begin() + 1, source.begin(), source.end());
+        assert(v.Size() == SIZE + SIZE / 2);
+        // В неинициализированную память за концом переезжают только последние SIZE / 2 элементов
+        assert(Obj::num_moved == num_moved + static_cast<int>(SIZE / 2));
+        v.Insert(v.begin() + v.Size() - 1, source.begin(), source.end());
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2 + SIZE / 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v[SIZE / 2].id = 42;
+        Vector<Obj> source(SIZE);
+        source[SIZE - 1].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 1, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // Вставка с реаллокацией не меняет вектор, если копирование прервалось исключением
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        assert(v[SIZE / 2].id == 42);
+        try {
+            v.Append(source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE * 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test13() {
+    const size_t SIZE = 100;
+    {
+        Vector<int> v;
+        for (int i = 0; i != static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(*it == 20);
+        assert(v.Size() == SIZE - 10);
+        assert(EraseIf(v, [](int x) {
+                   return x % 2 == 1;
+               }) == (SIZE - 10) / 2);
+        assert(v.Size() == (SIZE - 10) / 2);
+        assert(v[4] == 8);
+        assert(v[5] == 20);
+        assert(v[v.Size() - 1] == static_cast<int>(SIZE - 2));
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i != static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        int checked = 0;
+        try {
+            EraseIf(v, [&checked](const std::unique_ptr<int>& p) {
+                if (++checked == static_cast<int>(SIZE / 2)) {
+                    throw std::runtime_error("Oops");
+                }
+                return *p % 3 == 0;
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // После исключения в предикате удалённые элементы не возвращаются, а остальные сохраняют порядок
+        assert(v.Size() == SIZE - (SIZE / 2 + 2) / 3);
+        for (size_t i = 1; i != v.Size(); ++i) {
+            assert(*v[i - 1] < *v[i]);
+        }
+        assert(*v[v.Size() - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i != SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        assert(EraseIf(v, [](const Obj& obj) {
+                   return obj.id >= 10;
+               }) == SIZE - 10);
+        assert(v.Size() == 10);
+        v.Erase(v.begin(), v.begin() + 5);
+        assert(v[0].id == 5);
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test14() {
+    const size_t SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, DEFAULT_INIT);
+        assert(v.Size() == SIZE);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE));
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == static_cast<int>(SIZE * 2));
+        v.ResizeDefaultInit(SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v(SIZE, DEFAULT_INIT);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), 1);
+
+        const int source[] = {7, 8, 9};
+        // Новые элементы заполняются напрямую, как это сделал бы read()
+        v.ResizeUninitialized(SIZE + std::size(source));
+        std::memcpy(v.begin() + SIZE, source, sizeof(source));
+        assert(v.Size() == SIZE + std::size(source));
+        assert(v[SIZE - 1] == 1);
+        assert(v[SIZE + 2] == 9);
+        v.ResizeUninitialized(1);
+        assert(v.Size() == 1);
+        assert(v[0] == 1);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE * 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(SIZE / 2);
+        v[SIZE / 2 - 1].id = 42;
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        assert(v[SIZE / 2 - 1].id == 42);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2));
+
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v[0].id = 42;
+        const Obj* elements = &v[0];
+        auto [memory, size] = v.Release();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == 0);
+        assert(size == SIZE);
+        assert(memory.GetAddress() == elements);
+
+        Vector<Obj> other(SIZE / 2);
+        other.Adopt(std::move(memory), size);
+        assert(other.Size() == SIZE);
+        assert(&other[0] == elements);
+        assert(other[0].id == 42);
+        assert(Obj::num_copied == 0);
+        assert(Obj::num_moved == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE * 10);
+        v.Resize(SIZE);
+        v[SIZE - 1] = 42;
+        v.ShrinkToFit();
+        assert(v.Capacity() < SIZE * 10);
+        assert(v[SIZE - 1] == 42);
+    }
+}
+
+// Проверяется при сборке с -DVECTOR_ENABLE_STATS
+void Test16() {
+#ifdef VECTOR_ENABLE_STATS
+    const size_t SIZE = 100;
+    {
+        VectorStatsRegistry::Global().Reset();
+        Vector<Obj> v;
+        for (size_t i = 0; i != SIZE; ++i) {
+            v.EmplaceBack();
+        }
+        // Вместимость растёт как 1, 2, 4, ..., 128
+        const VectorStats& stats = v.GetStats();
+        assert(stats.allocations == 8);
+        assert(stats.reallocations == 7);
+        assert(stats.elements_moved == 1 + 2 + 4 + 8 + 16 + 32 + 64);
+        assert(stats.elements_copied == 0);
+        assert(stats.peak_capacity == 128);
+        assert(stats.bytes_allocated == 255 * sizeof(Obj));
+
+        Vector<std::string> strings(SIZE);
+        strings.Reserve(SIZE * 2);
+        assert(strings.GetStats().allocations == 2);
+        assert(strings.GetStats().elements_moved == SIZE);
+
+        Vector<int> ints(SIZE);
+        ints.PushBack(0);
+        assert(ints.GetStats().elements_relocated == SIZE);
+
+        // Освобождение буфера пустого вектора не считается выделением
+        Vector<int> emptied(SIZE);
+        emptied.Clear();
+        emptied.ShrinkToFit();
+        assert(emptied.Capacity() == 0 && emptied.GetStats().allocations == 1);
+
+        const VectorStats total = VectorStatsRegistry::Global().Snapshot();
+        assert(total.allocations == 8 + 2 + 2 + 1);
+        assert(total.peak_capacity == SIZE * 2);
+    }
+    {
+        // Буфер, который присваивание с неравными аллокаторами выделило во временном векторе,
+        // учитывается и в статистике вектора-приёмника
+        VectorStatsRegistry::Global().Reset();
+        size_t source_bytes = 0;
+        size_t target_bytes = 0;
+        Vector<int, CountingAllocator<int>> source(SIZE, CountingAllocator<int>(&source_bytes, 1));
+        Vector<int, CountingAllocator<int>> target(CountingAllocator<int>(&target_bytes, 2));
+        target = std::move(source);
+        assert(target_bytes == SIZE * sizeof(int));
+        assert(target.GetStats().allocations == 1 && target.GetStats().bytes_allocated == SIZE * sizeof(int));
+        assert(VectorStatsRegistry::Global().Snapshot().allocations == 2);
+    }
+    {
+        // Рост realloc на месте не считается ни выделением, ни переездом элементов
+        Vector<int, MallocAllocator<int>> v(1);
+        for (int i = 0; i != 20; ++i) {
+            const VectorStats before = v.GetStats();
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(v.begin());
+            v.Reserve(v.Capacity() + 16);
+            const bool in_place = reinterpret_cast<std::uintptr_t>(v.begin()) == address;
+            const VectorStats& after = v.GetStats();
+            assert(after.allocations - before.allocations == (in_place ? 0 : 1));
+            assert(after.reallocations - before.reallocations == (in_place ? 0 : 1));
+            assert(after.in_place_reallocations - before.in_place_reallocations == (in_place ? 1 : 0));
+        }
+    }
+#endif
+}
+
+template <size_t Alignment>
+bool IsAligned(const void* pointer) {
+    return reinterpret_cast<std::uintptr_t>(pointer) % Alignment == 0;
+}
+
+void Test17() {
+    const size_t SIZE = 1000;
+    {
+        Vector<float, AlignedAllocator<float, 64>> v;
+        static_assert(decltype(v)::BUFFER_ALIGNMENT == 64);
+        for (size_t i = 0; i != SIZE; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(IsAligned<64>(v.AssumeAligned()));
+        }
+        float sum = 0;
+        const float* data = v.AssumeAligned();
+        for (size_t i = 0; i != v.Size(); ++i) {
+            sum += data[i];
+        }
+        assert(sum == static_cast<float>(SIZE * (SIZE - 1) / 2));
+
+        Vector<float, AlignedAllocator<float, 64>> v_copy(v);
+        assert(IsAligned<64>(&v_copy[0]));
+    }
+    {
+        const size_t PAGE = 4096;
+        const size_t HUGE_PAGE = size_t{2} << 20;
+        Vector<double, AlignedAllocator<double, PAGE>> page_aligned(SIZE);
+        assert(IsAligned<PAGE>(page_aligned.AssumeAligned()));
+        Vector<char, AlignedAllocator<char, HUGE_PAGE>> huge_page_aligned(HUGE_PAGE);
+        assert(IsAligned<HUGE_PAGE>(huge_page_aligned.AssumeAligned()));
+    }
+    {
+        // Для типов с повышенным выравниванием std::allocator сам использует std::align_val_t
+        struct alignas(64) CacheLine {
+            char bytes[64];
+        };
+        Vector<CacheLine> v(3);
+        static_assert(decltype(v)::BUFFER_ALIGNMENT == 64);
+        assert(IsAligned<64>(v.AssumeAligned()));
+    }
+}
+
+template <typename T>
+void TestAlgorithmsFor(SimdLevel level) {
+    // Размеры вокруг границ блоков всех ядер, включая пустой вектор и неполные хвосты
+    for (size_t size = 0; size < 600; size += 1 + size / 8) {
+        Vector<T> v(size);
+        for (size_t i = 0; i != size; ++i) {
+            v[i] = static_cast<T>((i * 7) % 100);
+        }
+        assert(Sum(v.begin(), size, level) == std::accumulate(v.begin(), v.end(), T{}));
+        for (T value : {T{0}, T{42}, T{99}, T{100}}) {
+            assert(Find(v.begin(), size, value, level)
+                == static_cast<size_t>(std::find(v.begin(), v.end(), value) - v.begin()));
+            assert(Count(v.begin(), size, value, level)
+                == static_cast<size_t>(std::count(v.begin(), v.end(), value)));
+        }
+        if (size != 0) {
+            const auto [min, max] = std::minmax_element(v.begin(), v.end());
+            assert(MinMax(v.begin(), size, level) == std::make_pair(*min, *max));
+        }
+
+        Vector<T> doubled(size);
+        Transform(v.begin(), doubled.begin(), size, [](T x) { return static_cast<T>(x + x); }, level);
+        for (size_t i = 0; i != size; ++i) {
+            assert(doubled[i] == static_cast<T>(v[i] + v[i]));
+        }
+        // Преобразование на месте
+        Transform(doubled.begin(), doubled.begin(), size, [](T x) { return static_cast<T>(x - 1); }, level);
+        for (size_t i = 0; i != size; ++i) {
+            assert(doubled[i] == static_cast<T>(v[i] + v[i] - 1));
+        }
+        Fill(v.begin(), size, 3, level);
+        assert(std::count(v.begin(), v.end(), T{3}) == static_cast<std::ptrdiff_t>(size));
+    }
+}
+
+void Test18() {
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON}) {
+        if (!IsSimdLevelSupported(level)) {
+            continue;
+        }
+        TestAlgorithmsFor<int8_t>(level);
+        TestAlgorithmsFor<uint16_t>(level);
+        TestAlgorithmsFor<int32_t>(level);
+        TestAlgorithmsFor<int64_t>(level);
+        // Суммы небольших целых чисел представимы точно, поэтому порядок сложения не влияет на результат
+        TestAlgorithmsFor<float>(level);
+        TestAlgorithmsFor<double>(level);
+    }
+    {
+        Vector<double> v(100);
+        Fill(v, 1.5);
+        assert(Sum(v) == 150.0);
+        v[37] = -2.0;
+        v[64] = 8.0;
+        assert(Find(v, -2.0) == v.begin() + 37);
+        assert(Find(v, 7.0) == v.end());
+        assert(Count(v, 1.5) == 98);
+        assert(MinMax(v) == std::make_pair(-2.0, 8.0));
+
+        Vector<double> squares;
+        Transform(v, squares, [](double x) { return x * x; });
+        assert(squares.Size() == v.Size() && squares[37] == 4.0 && squares[0] == 2.25);
+        Transform(v, [](double x) { return -x; });
+        assert(v[64] == -8.0);
+    }
+}
+
+void Test19() {
+    const size_t SIZE = PARALLEL_MIN_CHUNK_SIZE * 4 + 3;
+    const size_t THREADS = 4;
+    {
+        Vector<std::string> source(SIZE);
+        for (size_t i = 0; i != SIZE; ++i) {
+            source[i] = std::to_string(i);
+        }
+        const Vector<std::string> copy = ParallelCopy(source, THREADS);
+        assert(copy.Size() == SIZE && copy.Capacity() == SIZE);
+        assert(std::equal(copy.begin(), copy.end(), source.begin()));
+
+        const Vector<std::string> small(3);
+        assert(ParallelCopy(small, THREADS).Size() == 3);
+    }
+    {
+        const auto v = ParallelConstruct<int>(SIZE, THREADS);
+        assert(v.Size() == SIZE && std::count(v.begin(), v.end(), 0) == static_cast<std::ptrdiff_t>(SIZE));
+    }
+    {
+        Vector<SharedObj> v = ParallelConstruct<SharedObj>(SIZE, THREADS);
+        assert(SharedObj::num_alive == static_cast<int>(SIZE));
+        ParallelDestroy(v, THREADS);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(SharedObj::num_alive == 0);
+    }
+    {
+        // Исключение в одной из частей уничтожает ровно созданные элементы всех частей
+        Vector<SharedObj> source(SIZE);
+        for (size_t throw_at : {size_t{0}, SIZE / 2, SIZE - 1}) {
+            source[throw_at].throw_on_copy = true;
+            try {
+                auto copy = ParallelCopy(source, THREADS);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            } catch (...) {
+                assert(false);
+            }
+            assert(SharedObj::num_alive == static_cast<int>(SIZE));
+            source[throw_at].throw_on_copy = false;
+        }
+    }
+    assert(SharedObj::num_alive == 0);
+}
+
+void Test20() {
+    {
+        ConcurrentVector<std::string> v;
+        const std::string& first = v.EmplaceBack("first");
+        const std::string* first_address = &first;
+        for (int i = 0; i != 1000; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        // Элементы не перемещаются при росте
+        assert(&v[0] == first_address && v[0] == "first");
+        assert(v.Size() == 1001 && v[1000] == "999");
+        assert(v.TryGet(1001) == nullptr);
+    }
+    {
+        const int THREADS = 4;
+        const int PER_THREAD = 20000;
+        ConcurrentVector<SharedObj> v;
+        std::atomic<int> visible_reads = 0;
+        Vector<std::thread> producers;
+        for (int t = 0; t != THREADS; ++t) {
+            producers.EmplaceBack([&v, &visible_reads, t] {
+                for (int i = 0; i != PER_THREAD; ++i) {
+                    SharedObj& obj = v.EmplaceBack();
+                    obj.id = t * PER_THREAD + i;
+                    // Читатели видят только полностью созданные элементы
+                    if (v.TryGet(v.Size() / 2) != nullptr) {
+                        ++visible_reads;
+                    }
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        assert(v.Size() == THREADS * PER_THREAD);
+        assert(SharedObj::num_alive == THREADS * PER_THREAD);
+        Vector<unsigned char> seen(v.Size());
+        for (size_t i = 0; i != v.Size(); ++i) {
+            assert(!seen[v[i].id]);
+            seen[v[i].id] = 1;
+        }
+        assert(visible_reads > 0);
+    }
+    assert(SharedObj::num_alive == 0);
+    {
+        // Исключение в конструкторе оставляет пустую ячейку, которая не уничтожается
+        ConcurrentVector<SharedObj> v;
+        v.Reserve(100);
+        SharedObj throwing;
+        throwing.throw_on_copy = true;
+        v.EmplaceBack();
+        try {
+            v.PushBack(throwing);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        v.EmplaceBack();
+        assert(v.Size() == 3 && v.TryGet(1) == nullptr && v.TryGet(2) != nullptr);
+        assert(SharedObj::num_alive == 3);
+    }
+    assert(SharedObj::num_alive == 0);
+}
+
+void Test21() {
+    {
+        StableVector<std::string, 4> v;
+        const std::string& first = v.EmplaceBack("first");
+        const auto first_it = v.cbegin();
+        for (int i = 0; i != 100; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        // Рост добавляет блоки и сегменты таблицы, не перемещая ни элементы, ни саму таблицу
+        assert(&v[0] == &first && v[0] == "first");
+        assert(&*first_it == &first && first_it[100] == "99");
+        assert(v.Size() == 101 && v.Capacity() == 104 && v[100] == "99");
+        // Аргумент может ссылаться на элемент вектора
+        v.PushBack(v[50]);
+        assert(v[101] == "49");
+
+        assert(v.end() - v.begin() == 102);
+        assert(std::find(v.begin(), v.end(), "42") - v.begin() == 43);
+        StableVector<std::string, 4>::const_iterator it = v.begin() + 8;
+        assert(*it == "7" && it[2] == "9" && it > v.cbegin());
+
+        v.PopBack();
+        v.PopBack();
+        assert(v.Size() == 100);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 100);
+
+        const Vector<std::string> flat = v.Flatten();
+        assert(flat.Size() == 100 && std::equal(flat.begin(), flat.end(), v.begin()));
+        StableVector<std::string, 4> copy(v);
+        const Vector<std::string> moved = std::move(copy).Flatten();
+        assert(moved.Size() == 100 && moved[99] == "98");
+        assert(copy.Size() == 0 && copy.Capacity() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        const size_t SIZE = 10;
+        StableVector<Obj, 4> v(SIZE);
+        assert(Obj::num_default_constructed == SIZE);
+        v[4].throw_on_copy = true;
+        try {
+            StableVector<Obj, 4> copy(v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+        StableVector<Obj, 4> moved(std::move(v));
+        assert(v.Size() == 0 && moved.Size() == SIZE);
+        moved[4].throw_on_copy = false;
+        v = moved;
+        v.Resize(3);
+        assert(Obj::GetAliveObjectCount() == SIZE + 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    static_assert(DEFAULT_CHUNK_SIZE<char> == 65536 && DEFAULT_CHUNK_SIZE<uint64_t> == 8192);
+}
+
+void Test22() {
+    {
+        IncrementalVector<std::string> v;
+        bool migrated_while_growing = false;
+        for (int i = 0; i != 1000; ++i) {
+            v.PushBack(std::to_string(i));
+            migrated_while_growing |= v.IsMigrating();
+            // Индексы направляются в старый или новый буфер прозрачно для вызывающего
+            assert(v[i] == std::to_string(i) && v[i / 2] == std::to_string(i / 2) && v[0] == "0");
+        }
+        assert(migrated_while_growing && v.Size() == 1000 && v.Capacity() == 1024);
+
+        // Перенос завершается задолго до следующего роста
+        while (v.Size() != 1024) {
+            v.PushBack("x");
+        }
+        assert(!v.IsMigrating());
+        v.PushBack(v[3]);
+        assert(v.IsMigrating() && v[1024] == "3");
+        // Аргумент, ссылающийся на ещё не перенесённый элемент, читается до переноса
+        v.EmplaceBack(std::move(v[1]));
+        assert(v[1025] == "1" && v[1].empty());
+
+        const IncrementalVector<std::string> copy(v);
+        assert(copy.Size() == v.Size() && !copy.IsMigrating());
+        for (size_t i = 0; i != v.Size(); ++i) {
+            assert(copy[i] == v[i]);
+        }
+        v.FinishMigration();
+        assert(!v.IsMigrating() && v[500] == "500");
+    }
+    {
+        Obj::ResetCounters();
+        {
+            IncrementalVector<Obj> v;
+            for (int i = 0; i != 65; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(v.IsMigrating() && v.Capacity() == 128);
+            // Старые элементы переносятся по два за добавление, а не все 64 сразу
+            assert(Obj::num_moved == 63 + 2);
+            while (v.Size() != 60) {
+                v.PopBack();
+            }
+            assert(v[59].id == 59 && v[0].id == 0);
+            IncrementalVector<Obj> moved(std::move(v));
+            assert(v.Size() == 0 && moved.Size() == 60);
+            v = moved;
+            v.Reserve(1000);
+            assert(!v.IsMigrating() && v.Capacity() == 1000 && v[30].id == 30);
+            assert(Obj::GetAliveObjectCount() == 120);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test23() {
+#ifdef VECTOR_TEST_MMAP
+    const std::string path = "mmap_vector_test.bin";
+    std::remove(path.c_str());
+    {
+        MmapVector<uint64_t> v(path);
+        assert(v.Size() == 0 && v.Data() == nullptr);
+        for (uint64_t i = 0; i != 100000; ++i) {
+            v.PushBack(i * i);
+        }
+        v.PushBack(v[7]);
+        assert(v.Size() == 100001 && v[100000] == 49 && v.Capacity() >= v.Size());
+        v.PopBack();
+        v.Advise(AccessPattern::SEQUENTIAL);
+        v.Sync();
+
+        // Второе отображение того же файла видит записи первого без копирования
+        MmapVector<uint64_t> shared(path);
+        assert(shared.Size() == v.Capacity());
+        v[5] = 12345;
+        assert(shared[5] == 12345);
+        shared[6] = 54321;
+        assert(v[6] == 54321);
+    }
+    {
+        // При закрытии файл обрезан до числа элементов
+        // Файл, открытый только для чтения, читается через тот же неконстантный интерфейс
+        MmapVector<const uint64_t> v(path);
+        static_assert(std::is_same_v<decltype(v[0]), const uint64_t&>);
+        static_assert(std::is_same_v<decltype(v.begin()), const uint64_t*>);
+        assert(v.Size() == 100000 && v[99999] == uint64_t{99999} * 99999 && v[5] == 12345);
+        uint64_t sum = 0;
+        for (uint64_t value : v) {
+            sum += value;
+        }
+        assert(sum == uint64_t{333328333350000} - 25 + 12345 - 36 + 54321);
+
+        MmapVector<const uint64_t> moved(std::move(v));
+        assert(v.Size() == 0 && moved.Size() == 100000);
+        moved.Advise(AccessPattern::RANDOM);
+    }
+    {
+        // Размер файла должен быть кратен размеру элемента
+        bool thrown = false;
+        try {
+            MmapVector<const std::array<char, 3>> v(path);
+        } catch (const std::system_error& e) {
+            thrown = e.code() == std::errc::invalid_argument;
+        }
+        assert(thrown);
+    }
+    std::remove(path.c_str());
+    {
+        bool thrown = false;
+        try {
+            MmapVector<const int> v(path);
+        } catch (const std::system_error& e) {
+            thrown = e.code() == std::errc::no_such_file_or_directory;
+        }
+        assert(thrown);
+    }
+#endif
+}
+
+void Test24() {
+    {
+        Vector<uint64_t> v(1000);
+        std::iota(v.begin(), v.end(), 0);
+        Vector<char> buffer;
+        BufferWriter writer(buffer);
+        Serialize(v, writer);
+        assert(buffer.Size() == SerializedSize(v) && buffer.Size() == sizeof(SerializationHeader) + 8000);
+
+        BufferReader reader(buffer.begin(), buffer.Size());
+        const Vector<uint64_t> copy = Deserialize<uint64_t>(reader);
+        assert(copy.Size() == 1000 && copy[999] == 999 && reader.Remaining() == 0);
+
+        // Просмотр указывает прямо в буфер сообщения. Буфер Vector<char> выровнен для uint64_t
+        const Span<const uint64_t> view = DeserializeView<uint64_t>(buffer.begin(), buffer.Size());
+        assert(view.Size() == 1000 && view[500] == 500);
+        assert(reinterpret_cast<const char*>(view.Data()) == buffer.begin() + sizeof(SerializationHeader));
+
+        const auto expect_error = [&buffer](auto deserialize) {
+            try {
+                deserialize(buffer);
+            } catch (const SerializationError&) {
+                return true;
+            }
+            return false;
+        };
+        const auto view_u64 = [](const Vector<char>& b) {
+            DeserializeView<uint64_t>(b.begin(), b.Size());
+        };
+        // Повреждение данных или заголовка обнаруживается по контрольной сумме
+        buffer[sizeof(SerializationHeader) + 17] ^= 1;
+        assert(expect_error(view_u64));
+        buffer[sizeof(SerializationHeader) + 17] ^= 1;
+        buffer[offsetof(SerializationHeader, count)] ^= 1;
+        assert(expect_error(view_u64));
+        buffer[offsetof(SerializationHeader, count)] ^= 1;
+        // Тип с другим размером элемента и обрезанное сообщение отвергаются
+        assert(expect_error([](const Vector<char>& b) {
+            DeserializeView<uint32_t>(b.begin(), b.Size());
+        }));
+        assert(expect_error([](const Vector<char>& b) {
+            BufferReader r(b.begin(), b.Size() - 1);
+            Deserialize<uint64_t>(r);
+        }));
+        // При ошибке вектор-приёмник не меняется
+        Vector<uint64_t> target(3);
+        buffer[buffer.Size() - 1] ^= 1;
+        BufferReader corrupted(buffer.begin(), buffer.Size());
+        try {
+            Deserialize(corrupted, target);
+            assert(false);
+        } catch (const SerializationError&) {
+        }
+        assert(target.Size() == 3);
+    }
+    {
+        // Нетривиальные типы записываются поэлементно, в том числе вложенные векторы
+        Vector<Vector<std::string>> v;
+        v.EmplaceBack();
+        v.EmplaceBack(2);
+        v[1][0] = "hello";
+        v[1][1] = std::string(100, 'x');
+        std::stringstream stream;
+        StreamWriter writer(stream);
+        Serialize(v, writer);
+        assert(stream.str().size() == SerializedSize(v));
+        StreamReader reader(stream);
+        const auto copy = Deserialize<Vector<std::string>>(reader);
+        assert(copy.Size() == 2 && copy[0].Size() == 0 && copy[1][0] == "hello" && copy[1][1] == v[1][1]);
+
+        Vector<std::string> empty;
+        std::stringstream empty_stream;
+        StreamWriter empty_writer(empty_stream);
+        Serialize(empty, empty_writer);
+        StreamReader empty_reader(empty_stream);
+        assert(Deserialize<std::string>(empty_reader).Size() == 0);
+
+        // Искажённый payload_size отвергается по контрольной сумме заголовка, а не попыткой выделить терабайт
+        std::string message = stream.str();
+        message[offsetof(SerializationHeader, payload_size) + 5] ^= 1;
+        std::stringstream corrupted_stream(message);
+        StreamReader corrupted_reader(corrupted_stream);
+        try {
+            Deserialize<Vector<std::string>>(corrupted_reader);
+            assert(false);
+        } catch (const SerializationError& e) {
+            assert(std::string(e.what()) == "Header checksum mismatch");
+        }
+    }
+    {
+        // Результат контрольной суммы не зависит от разбиения данных на части
+        const std::string data = "The quick brown fox jumps over the lazy dog";
+        Checksum whole;
+        whole.Update(data.data(), data.size());
+        Checksum parts;
+        for (size_t i = 0; i < data.size(); i += 3) {
+            parts.Update(data.data() + i, std::min<size_t>(3, data.size() - i));
+        }
+        assert(whole.Value() == parts.Value());
+    }
+    {
+        // Тривиально копируемый тип с инициализаторами членов читается тем же побайтовым путём
+        struct Point {
+            int x = 0;
+            double y = 0;
+        };
+        Vector<Point> v;
+        for (int i = 0; i != 10; ++i) {
+            v.PushBack(Point{ i, i * 0.5 });
+        }
+        Vector<char> buffer;
+        BufferWriter writer(buffer);
+        Serialize(v, writer);
+        BufferReader reader(buffer.begin(), buffer.Size());
+        const Vector<Point> result = Deserialize<Point>(reader);
+        assert(result.Size() == 10);
+        for (int i = 0; i != 10; ++i) {
+            assert(result[i].x == i && result[i].y == i * 0.5);
+        }
+    }
+#ifdef VECTOR_TEST_MMAP
+    {
+        // Заголовок и данные записываются в файл одним writev и читаются обратно через mmap
+        const std::string path = "serialization_test.bin";
+        Vector<double> v(100);
+        std::iota(v.begin(), v.end(), 0.5);
+        {
+            const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            assert(fd >= 0);
+            FdWriter writer(fd);
+            Serialize(v, writer);
+            ::close(fd);
+        }
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            FdReader reader(fd);
+            assert(Deserialize<double>(reader)[99] == 99.5);
+            ::close(fd);
+        }
+        {
+            MmapVector<const char> file(path);
+            const Span<const double> view = DeserializeView<double>(file.Data(), file.Size());
+            assert(view.Size() == 100 && view[10] == 10.5);
+        }
+        std::remove(path.c_str());
+    }
+#endif
+}
+
+// Тип без перемещающего конструктора, копирование которого выбрасывает исключение по счётчику
+struct CopyOnly {
+    explicit CopyOnly(int value)
+        : value(value) {
+    }
+
+    CopyOnly(const CopyOnly& other)
+        : value(other.value) {
+        if (copies_before_throw > 0 && --copies_before_throw == 0) {
+            throw std::runtime_error("Copy failed");
+        }
+    }
+
+    CopyOnly& operator=(const CopyOnly&) = default;
+
+    int value;
+    static inline int copies_before_throw = 0;
+};
+
+void Test25() {
+    {
+        SoAVector<int, std::string, double> v;
+        for (int i = 0; i != 100; ++i) {
+            auto [id, name, weight] = v.EmplaceBack(i, std::to_string(i), i * 0.5);
+            assert(id == i && name == std::to_string(i) && weight == i * 0.5);
+        }
+        assert(v.Size() == 100 && v.Capacity() == 128);
+        // Столбец непрерывен и хранится отдельно от остальных полей
+        const Span<int> ids = v.Column<0>();
+        assert(ids.Size() == 100 && std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+        assert(v.Data<2>()[10] == 5.0);
+
+        // Аргументы, ссылающиеся на элементы вектора, читаются до переноса в новые буферы
+        while (v.Size() != v.Capacity()) {
+            v.EmplaceBack(0, "", 0.0);
+        }
+        v.EmplaceBack(std::get<0>(v[3]), std::move(std::get<1>(v[5])), std::get<2>(v[7]));
+        assert(v.Size() == 129 && v.Capacity() == 256);
+        assert(v[128] == std::make_tuple(3, std::string("5"), 3.5) && std::get<1>(v[5]).empty());
+
+        int sum = 0;
+        for (auto [id, name, weight] : v) {
+            sum += id;
+            name += "!";
+            weight = 1.0;
+        }
+        assert(sum == 4950 + 3 && std::get<1>(v[0]) == "0!" && std::get<2>(v[99]) == 1.0);
+        const auto& const_v = v;
+        assert(std::distance(const_v.begin(), const_v.end()) == 129 && std::get<1>(*(const_v.begin() + 2)) == "2!");
+
+        SoAVector<int, std::string, double> copy(v);
+        v.Resize(10);
+        assert(v.Size() == 10 && copy.Size() == 129 && std::get<1>(copy[128]) == "5!");
+        v.Resize(12);
+        assert(v[11] == std::make_tuple(0, std::string(), 0.0));
+        v = std::move(copy);
+        assert(v.Size() == 129 && copy.Size() == 0);
+        v.PopBack();
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 129);
+    }
+    {
+        // Перенос столбца, тип которого копируется с исключением, не портит остальные столбцы
+        static_assert(!std::is_nothrow_move_constructible_v<CopyOnly>);
+
+        Obj::ResetCounters();
+        {
+            SoAVector<Obj, CopyOnly> v;
+            v.Reserve(4);
+            for (int i = 0; i != 4; ++i) {
+                v.EmplaceBack(i, CopyOnly(i));
+            }
+            CopyOnly::copies_before_throw = 3;
+            try {
+                v.EmplaceBack(4, CopyOnly(4));
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            // Вектор остался прежним, а уже перемещённые в новый буфер элементы Obj не утекли
+            assert(v.Size() == 4 && v.Capacity() == 4 && Obj::GetAliveObjectCount() == 4);
+            for (int i = 0; i != 4; ++i) {
+                assert(std::get<0>(v[i]).id == i && std::get<1>(v[i]).value == i);
+            }
+            CopyOnly::copies_before_throw = 0;
+            v.Reserve(16);
+            assert(Obj::num_moved == 4 && Obj::GetAliveObjectCount() == 4 && std::get<1>(v[3]).value == 3);
+
+            Obj::default_construction_throw_countdown = 3;
+            try {
+                SoAVector<std::string, Obj> failed(5);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(Obj::GetAliveObjectCount() == 4);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test26() {
+    using PoolVector = Vector<int, PoolAllocator<int>>;
+    BufferPool& pool = BufferPool::Global();
+    pool.FlushThreadCache();
+    pool.ReleaseCentralCache();
+    const PoolStats before = BufferPool::Stats();
+    const int* first_buffer = nullptr;
+    {
+        PoolVector v;
+        v.Reserve(100);
+        // Вместимость округлена до класса размера: 400 байт -> блок 512 байт
+        assert(v.Capacity() == 128);
+        first_buffer = v.begin();
+        for (int i = 0; i != 1000; ++i) {
+            v.PushBack(i);
+        }
+    }
+    {
+        // Освобождённые блоки возвращаются из кэша потока следующим векторам того же порядка
+        PoolVector v;
+        v.Reserve(120);
+        assert(v.begin() == first_buffer && v.Capacity() == 128);
+        const PoolVector copy(v);
+        v.Resize(900);
+        assert(copy.Capacity() == 0 && v.Capacity() == 1024 && std::accumulate(v.begin(), v.end(), 0) == 0);
+    }
+    // Новые блоки выделялись только при первом росте до 1000 элементов
+    const PoolStats& stats = BufferPool::Stats();
+    assert(stats.thread_cache_hits == before.thread_cache_hits + 2);
+    assert(stats.system_allocations == before.system_allocations + 4);
+
+    // Векторы, созданные в другом потоке, освобождаются здесь; его кэш при завершении переходит в общий
+    Vector<PoolVector> from_thread;
+    std::thread producer([&from_thread] {
+        for (int i = 0; i != 100; ++i) {
+            from_thread.EmplaceBack(64);
+        }
+        PoolVector(64).Swap(from_thread[0]);
+        assert(BufferPool::Stats().thread_cache_hits == 0);
+    });
+    producer.join();
+    const size_t central_hits = stats.central_cache_hits;
+    {
+        PoolVector reused(60);
+        assert(reused.Capacity() == 64 && stats.central_cache_hits == central_hits + 1);
+    }
+    from_thread.Clear();
+    pool.FlushThreadCache();
+    std::thread consumer([] {
+        const PoolVector v(64);
+        assert(BufferPool::Stats().central_cache_hits == 1 && BufferPool::Stats().system_allocations == 0);
+    });
+    consumer.join();
+
+    // При нулевых пределах блоки сразу возвращаются operator delete
+    const PoolLimits limits = pool.GetLimits();
+    pool.SetLimits({ 0, 0, 1 });
+    pool.FlushThreadCache();
+    pool.ReleaseCentralCache();
+    const size_t frees = stats.system_frees;
+    {
+        PoolVector v(10);
+    }
+    assert(stats.system_frees == frees + 1);
+    pool.SetLimits(limits);
+
+    // Запросы крупнее MAX_BLOCK_SIZE не округляются
+    Vector<char, PoolAllocator<char>> large(BufferPool::MAX_BLOCK_SIZE + 1);
+    assert(large.Capacity() == BufferPool::MAX_BLOCK_SIZE + 1);
+}
+
+void Test27() {
+    constexpr size_t LARGE = NUMA_MIN_ALLOCATION / sizeof(int) + 1;
+    {
+        using NumaVector = Vector<int, NumaAllocator<int>>;
+        // Небольшие буферы выделяются как обычно
+        NumaVector small(10, NumaAllocator<int>(NumaPlacement::Interleave()));
+        assert(small.Capacity() == 10);
+
+        NumaVector bound(LARGE, NumaAllocator<int>(NumaPlacement::Bind(0)));
+        // Крупный буфер занимает целые страницы, и вектор получает всю их вместимость
+        assert(bound.Capacity() >= LARGE && bound.Capacity() * sizeof(int) % numa_detail::PageSize() == 0);
+        assert(std::accumulate(bound.begin(), bound.end(), 0) == 0);
+        const int node = NumaNodeOf(&bound[LARGE / 2]);
+        assert(node == 0 || node == -1);
+        const NumaVector copy(bound);
+        assert(copy.GetAllocator().GetPlacement().policy == NumaPolicy::BIND && copy.Size() == LARGE);
+
+        bool thrown = false;
+        try {
+            NumaVector invalid(LARGE, NumaAllocator<int>(NumaPlacement::Bind(numa_detail::MAX_NODES)));
+        } catch (const std::system_error& e) {
+            thrown = e.code() == std::errc::invalid_argument;
+        }
+        assert(thrown);
+    }
+    {
+        // Первая запись в страницы выполняется теми же частями, которыми вектор потом обрабатывается
+        const size_t threads = 4;
+        const size_t size = PARALLEL_MIN_CHUNK_SIZE * threads;
+        auto v = ParallelConstruct<int, NumaAllocator<int>>(size, threads);
+        std::atomic<size_t> chunks = 0;
+        ParallelFor(v.Size(), threads, [&v, &chunks](size_t begin, size_t end) {
+            std::iota(v.begin() + begin, v.begin() + end, static_cast<int>(begin));
+            ++chunks;
+        });
+        assert(chunks == threads && v[size - 1] == static_cast<int>(size - 1));
+
+        ParallelResize(v, size * 3, threads);
+        assert(v.Size() == size * 3 && v[size - 1] == static_cast<int>(size - 1) && v[size * 3 - 1] == 0);
+        ParallelResize(v, 5, threads);
+        assert(v.Size() == 5 && v[4] == 4);
+
+        bool thrown = false;
+        try {
+            ParallelFor(size, threads, [](size_t begin, size_t /*end*/) {
+                if (begin != 0) {
+                    throw std::runtime_error("Chunk failed");
+                }
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {
+        // При исключении ParallelResize оставляет прежние элементы
+        SharedObj::num_alive = 0;
+        {
+            Vector<SharedObj> v(3);
+            v[2].id = 7;
+            SharedObj::default_construction_throw_countdown = 2 * PARALLEL_MIN_CHUNK_SIZE;
+            try {
+                ParallelResize(v, 4 * PARALLEL_MIN_CHUNK_SIZE, 4);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 3 && v[2].id == 7 && SharedObj::num_alive == 3);
+        }
+        assert(SharedObj::num_alive == 0);
+    }
+}
+
+void Test28() {
+    {
+        CowVector<std::string> empty;
+        assert(empty.Size() == 0 && empty.UseCount() == 0 && empty.begin() == empty.end());
+        CowVector<std::string> empty_copy(empty);
+        empty_copy.PushBack("a");
+        assert(empty.Size() == 0 && empty_copy.Size() == 1 && empty_copy.UseCount() == 1);
+    }
+    {
+        Vector<std::string> data;
+        data.PushBack("alpha");
+        data.PushBack("beta");
+        data.PushBack("gamma");
+        const CowVector<std::string> original(std::move(data));
+        CowVector<std::string> snapshot(original);
+        // Копия разделяет буфер
+        assert(original.UseCount() == 2 && &snapshot.Get()[0] == &original.Get()[0]);
+        const std::string* shared = &original[1];
+
+        // Первое изменение отделяет буфер, оригинал не меняется
+        snapshot[1] = "BETA";
+        assert(!snapshot.IsShared() && !original.IsShared());
+        assert(original[1] == "beta" && &original[1] == shared && snapshot[1] == "BETA");
+        // Повторные изменения не копируют элементы
+        const std::string* own = &snapshot[0];
+        snapshot[0] = "ALPHA";
+        assert(&snapshot[0] == own);
+
+        CowVector<std::string> appended(original);
+        appended.PushBack("delta");
+        assert(appended.Size() == 4 && appended.Capacity() >= 4 && original.Size() == 3);
+
+        CowVector<std::string> erased(original);
+        erased.Erase(erased.cbegin() + 1);
+        assert(erased.Size() == 2 && erased[1] == "gamma" && original[1] == "beta");
+        CowVector<std::string> inserted(original);
+        inserted.Insert(inserted.cbegin(), "zero");
+        assert(inserted[0] == "zero" && inserted.Size() == 4 && original[0] == "alpha");
+
+        CowVector<std::string> shrunk(original);
+        shrunk.Resize(1);
+        assert(shrunk.Size() == 1 && shrunk.Capacity() == 1 && shrunk[0] == "alpha" && original.Size() == 3);
+        CowVector<std::string> cleared(original);
+        cleared.Clear();
+        assert(cleared.Size() == 0 && original.UseCount() == 1);
+
+        CowVector<std::string> assigned;
+        assigned = original;
+        assert(original.UseCount() == 2);
+        assigned = std::move(snapshot);
+        assert(original.UseCount() == 1 && assigned[0] == "ALPHA");
+    }
+    {
+        // Исключение при отделении буфера оставляет общий буфер
+        SharedObj::num_alive = 0;
+        {
+            Vector<SharedObj> data(3);
+            data[2].throw_on_copy = true;
+            CowVector<SharedObj> original(std::move(data));
+            CowVector<SharedObj> snapshot(original);
+            try {
+                snapshot[0].id = 1;
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(snapshot.IsShared() && original.Get()[0].id == 0 && SharedObj::num_alive == 3);
+        }
+        assert(SharedObj::num_alive == 0);
+    }
+    {
+        // Снимки передаются в другие потоки и освобождаются там
+        SharedObj::num_alive = 0;
+        {
+            CowVector<SharedObj> published(1000);
+            Vector<std::thread> readers;
+            std::atomic<size_t> sizes = 0;
+            for (int t = 0; t != 4; ++t) {
+                readers.EmplaceBack([snapshot = published, &sizes]() mutable {
+                    for (int i = 0; i != 1000; ++i) {
+                        CowVector<SharedObj> local(snapshot);
+                        sizes += local.Size();
+                    }
+                    snapshot.Resize(10);
+                    assert(!snapshot.IsShared());
+                });
+            }
+            for (std::thread& reader : readers) {
+                reader.join();
+            }
+            assert(sizes == 4 * 1000 * 1000 && published.UseCount() == 1);
+        }
+        assert(SharedObj::num_alive == 0);
+    }
+}
+
+void Test29() {
+    const size_t SMALL_SIZE = 10;
+    const size_t LARGE_SIZE = 100;
+    {
+        // Перемещение забирает буфер, не перемещая и не копируя элементы
+        Obj::ResetCounters();
+        {
+            Vector<Obj> large(LARGE_SIZE);
+            Vector<Obj> small(SMALL_SIZE);
+            small[SMALL_SIZE - 1].id = 1;
+            const Obj* small_data = &small[0];
+            large = std::move(small);
+            assert(large.Size() == SMALL_SIZE && large.Capacity() == SMALL_SIZE && &large[0] == small_data);
+            assert(large[SMALL_SIZE - 1].id == 1 && small.Size() == 0 && small.Capacity() == 0);
+            assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+            // Прежние элементы уничтожены все, не больше и не меньше
+            assert(Obj::GetAliveObjectCount() == static_cast<int>(SMALL_SIZE));
+
+            Vector<Obj> larger(LARGE_SIZE);
+            larger = std::move(large);
+            assert(larger.Size() == SMALL_SIZE && Obj::GetAliveObjectCount() == static_cast<int>(SMALL_SIZE));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Тривиально копируемые элементы: в пределах вместимости буфер не меняется
+        Vector<int> source(LARGE_SIZE);
+        std::iota(source.begin(), source.end(), 0);
+        Vector<int> target(SMALL_SIZE);
+        target.Reserve(LARGE_SIZE * 2);
+        const int* target_data = target.begin();
+        target = source;
+        assert(target.Size() == LARGE_SIZE && target.begin() == target_data && target[LARGE_SIZE - 1] == 99);
+
+        Vector<int> prefix(SMALL_SIZE);
+        std::iota(prefix.begin(), prefix.end(), 1000);
+        target = prefix;
+        assert(target.Size() == SMALL_SIZE && target.begin() == target_data && target[0] == 1000);
+        assert(target.Capacity() == LARGE_SIZE * 2);
+
+        Vector<int> grown(SMALL_SIZE);
+        grown = source;
+        assert(grown.Size() == LARGE_SIZE && grown.Capacity() == LARGE_SIZE && grown[50] == 50);
+        Vector<int> empty;
+        grown = empty;
+        assert(grown.Size() == 0 && grown.Capacity() == LARGE_SIZE);
+    }
+}
+
+// Маршрут вычисляется при компиляции: все операции StaticVector над литеральным типом constexpr
+constexpr int StaticRouteChecksum() {
+    StaticVector<int, 8> route{1, 2, 3};
+    route.PushBack(5);
+    route.Insert(route.begin() + 3, 4);
+    route.Emplace(route.begin(), 0);
+    route.Erase(route.begin() + 1);
+    route.Resize(route.Size() + 1);
+    StaticVector<int, 8> copy = route;
+    copy.PopBack();
+    int checksum = 0;
+    for (int hop : copy) {
+        checksum = checksum * 10 + hop;
+    }
+    return checksum * 10 + static_cast<int>(route.Size());
+}
+
+static_assert(StaticRouteChecksum() == 2345 * 10 + 6);
+static_assert(std::is_trivially_copyable_v<StaticVector<int, 4>>);
+
+void Test30() {
+    {
+        StaticVector<std::string, 4> headers;
+        static_assert(StaticVector<std::string, 4>::Capacity() == 4);
+        headers.EmplaceBack(20, 'x');
+        headers.PushBack("Host");
+        headers.Insert(headers.begin(), headers[1]);
+        assert(headers.Size() == 3 && headers[0] == "Host" && headers[1] == std::string(20, 'x'));
+        // Вектор находится в самом объекте, поэтому элементы лежат внутри него
+        const auto* object = reinterpret_cast<const char*>(&headers);
+        const auto* first = reinterpret_cast<const char*>(headers.begin());
+        assert(first >= object && first < object + sizeof(headers));
+
+        headers.PushBack("Accept");
+        bool thrown = false;
+        try {
+            headers.PushBack("Overflow");
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown && headers.Size() == 4 && headers[3] == "Accept");
+        thrown = false;
+        try {
+            headers.Resize(5);
+        } catch (const std::length_error&) {
+            thrown = true;
+        }
+        assert(thrown && headers.Size() == 4);
+
+        headers.Erase(headers.begin() + 1, headers.begin() + 3);
+        assert(headers.Size() == 2 && headers[0] == "Host" && headers[1] == "Accept");
+        StaticVector<std::string, 4> moved(std::move(headers));
+        assert(moved.Size() == 2 && headers.Size() == 0);
+        StaticVector<std::string, 4> other{"a", "b", "c"};
+        other.Swap(moved);
+        assert(other.Size() == 2 && other[1] == "Accept" && moved.Size() == 3 && moved[2] == "c");
+        other = moved;
+        assert(other.Size() == 3 && other[0] == "a");
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 8> v(3);
+            assert(Obj::num_default_constructed == 3);
+            v.EmplaceBack(1);
+            v.Emplace(v.begin(), 2, "two");
+            assert(v[0].id == 2 && v[4].id == 1 && Obj::GetAliveObjectCount() == 5);
+            v.Resize(1);
+            assert(v.Size() == 1 && Obj::GetAliveObjectCount() == 1);
+            StaticVector<Obj, 8> copy(v);
+            assert(Obj::num_copied == 1 && Obj::GetAliveObjectCount() == 2);
+            v.Clear();
+            assert(Obj::GetAliveObjectCount() == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Тривиально копируемые типы без присваивания создаются на месте, как в Vector
+        struct Tagged {
+            const int tag = 7;
+            double value = 0;
+        };
+        static_assert(std::is_trivially_copyable_v<Tagged> && !std::is_copy_assignable_v<Tagged>);
+        StaticVector<Tagged, 4> v(2);
+        v.EmplaceBack(Tagged{ 1, 0.5 });
+        v.Resize(1);
+        v.PushBack(Tagged{ 2, 1.5 });
+        assert(v.Size() == 2 && v[0].tag == 7 && v[1].tag == 2 && v[1].value == 1.5);
+        const StaticVector<Tagged, 4> copy(v);
+        assert(copy.Size() == 2 && copy[1].tag == 2);
+    }
+}
+
+void Test31() {
+    {
+        Vector<int> empty;
+        assert(empty.Data() == nullptr && empty.AsSpan().Size() == 0);
+        size_t calls = 0;
+        empty.ForEachChunk([&calls](Span<int>) {
+            ++calls;
+        });
+        assert(calls == 0);
+    }
+    {
+        const size_t SIZE = 10'000;
+        Vector<int> v(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        assert(v.Data() == v.begin() && &v.UncheckedAt(SIZE - 1) == &v[SIZE - 1]);
+        const Span<const int> span = std::as_const(v).AsSpan();
+        assert(span.Size() == SIZE && span.Data() == v.Data());
+
+        // Части идут подряд и покрывают весь вектор, последняя короче
+        Vector<size_t> sizes;
+        const int* expected = v.Data();
+        std::as_const(v).ForEachChunk(
+            [&sizes, &expected](Span<const int> chunk) {
+                assert(chunk.Data() == expected);
+                expected += chunk.Size();
+                sizes.PushBack(chunk.Size());
+            },
+            3000);
+        assert(sizes.Size() == 4 && sizes[0] == 3000 && sizes[3] == 1000 && expected == v.Data() + SIZE);
+
+        // По умолчанию часть занимает 4 КиБ
+        size_t chunks = 0;
+        v.ForEachChunk([&chunks](Span<int> chunk) {
+            assert(chunk.Size() == FOR_EACH_CHUNK_BYTES / sizeof(int) || chunk.Size() == SIZE % 1024);
+            for (int& x : chunk) {
+                x *= 2;
+            }
+            ++chunks;
+        });
+        assert(chunks == (SIZE + 1023) / 1024 && v[SIZE - 1] == static_cast<int>(SIZE - 1) * 2);
+    }
+    {
+        // Элементы крупнее части по умолчанию передаются по одному
+        struct Page {
+            char bytes[8192];
+        };
+        Vector<Page> pages(3);
+        size_t chunks = 0;
+        pages.ForEachChunk([&chunks](Span<Page> chunk) {
+            assert(chunk.Size() == 1);
+            ++chunks;
+        });
+        assert(chunks == 3);
+    }
+}
+
+void Test32() {
+    {
+        Vector<char> buffer;
+        Span<char> spare = buffer.SpareCapacity(10);
+        assert(spare.Size() >= 10 && spare.Data() == buffer.Data() && buffer.Size() == 0);
+        std::memcpy(spare.Data(), "header", 6);
+        buffer.CommitAppend(6);
+        assert(buffer.Size() == 6 && std::string(buffer.begin(), buffer.end()) == "header");
+        // Достаточно места — буфер не меняется
+        const size_t capacity = buffer.Capacity();
+        spare = buffer.SpareCapacity(capacity - 6);
+        assert(buffer.Capacity() == capacity && spare.Data() == buffer.Data() + 6);
+        // Недостаточно — буфер растёт геометрически
+        spare = buffer.SpareCapacity(capacity - 5);
+        assert(buffer.Capacity() == capacity * 2 && std::string(buffer.begin(), buffer.end()) == "header");
+    }
+    {
+        // Источник отдаёт поток небольшими пакетами, как сокет
+        std::string message(100'000, ' ');
+        for (size_t i = 0; i != message.size(); ++i) {
+            message[i] = static_cast<char>('a' + i % 26);
+        }
+        std::istringstream stream(message);
+        Vector<char> received;
+        size_t reads = 0;
+        size_t allocations = 0;
+        const char* data = nullptr;
+        const size_t appended = received.AppendFrom([&](Span<char> spare) {
+            assert(spare.Size() >= 1500);
+            ++reads;
+            if (received.Data() != data) {
+                data = received.Data();
+                ++allocations;
+            }
+            stream.read(spare.Data(), std::min<std::streamsize>(1500, spare.Size()));
+            return static_cast<size_t>(stream.gcount());
+        }, 1500);
+        assert(appended == message.size() && std::string(received.begin(), received.end()) == message);
+        assert(reads == (message.size() + 1499) / 1500 + 1 && allocations <= 8);
+
+        // Декодер пишет значения прямо в вектор
+        Vector<uint32_t> values;
+        values.PushBack(7);
+        uint32_t next = 0;
+        values.AppendFrom([&next](Span<uint32_t> spare) {
+            size_t count = 0;
+            for (; count != spare.Size() && next != 1000; ++count) {
+                spare[count] = next++;
+            }
+            return count;
+        });
+        assert(values.Size() == 1001 && values[0] == 7 && values[1000] == 999);
+
+        bool thrown = false;
+        try {
+            values.AppendFrom([](Span<uint32_t> spare) -> size_t {
+                if (spare.Size() > 0) {
+                    throw std::runtime_error("Connection reset");
+                }
+                return 0;
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && values.Size() == 1001);
+    }
+}
+
+void Test33() {
+    {
+        // Поиск без ветвлений на всех размерах, включая пустой диапазон
+        for (size_t size = 0; size != 40; ++size) {
+            Vector<int> sorted(size);
+            for (size_t i = 0; i != size; ++i) {
+                sorted[i] = static_cast<int>(i) * 2;
+            }
+            for (int key = -1; key <= static_cast<int>(size) * 2; ++key) {
+                const int* pos = flat_detail::BranchlessLowerBound(sorted.Data(), size, key, flat_detail::Identity(),
+                    std::less<int>());
+                assert(pos == std::lower_bound(sorted.begin(), sorted.end(), key));
+            }
+        }
+    }
+    {
+        FlatSet<int> set{5, 1, 3, 1, 9};
+        assert(set.Size() == 4 && std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(3) && !set.Contains(4) && set.Count(9) == 1);
+        assert(set.Insert(4).second && !set.Insert(4).second && set.Size() == 5);
+        assert(*set.LowerBound(2) == 3 && *set.UpperBound(4) == 5 && set.LowerBound(10) == set.end());
+        assert(set.Erase(1) == 1 && set.Erase(1) == 0 && *set.begin() == 3);
+
+        const int more[] = {8, 2, 9, 2, 7};
+        set.InsertBulk(std::begin(more), std::end(more));
+        const Vector<int>& elements = set.Elements();
+        const int expected[] = {2, 3, 4, 5, 7, 8, 9};
+        assert(std::equal(elements.begin(), elements.end(), std::begin(expected), std::end(expected)));
+
+        FlatSet<int, std::greater<int>> descending{1, 3, 2};
+        assert(*descending.begin() == 3 && *descending.Find(1) == 1);
+    }
+    {
+        FlatMap<std::string, int> routes{{"b", 2}, {"a", 1}, {"b", 20}};
+        // Из равных ключей остаётся первый
+        assert(routes.Size() == 2 && routes.At("b") == 2 && routes.begin()->first == "a");
+        routes["c"] = 3;
+        ++routes["a"];
+        assert(routes.At("a") == 2 && routes.Size() == 3);
+        assert(!routes.TryEmplace("c", 30).second && routes.At("c") == 3);
+        assert(!routes.InsertOrAssign("c", 30).second && routes.At("c") == 30);
+        assert(routes.Insert({"0", 0}).second && routes.begin()->first == "0");
+        routes.Find("b")->second = 200;
+        assert(routes.At("b") == 200 && routes.Find("x") == routes.end());
+        bool thrown = false;
+        try {
+            routes.At("x");
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        // Существующие ключи при пакетной вставке сохраняют свои значения
+        Vector<std::pair<std::string, int>> batch;
+        batch.PushBack({"z", 26});
+        batch.PushBack({"a", 100});
+        batch.PushBack({"m", 13});
+        routes.InsertBulk(std::move(batch));
+        assert(routes.Size() == 6 && routes.At("a") == 2 && routes.At("m") == 13 && (routes.end() - 1)->first == "z");
+        assert(routes.Erase("m") == 1 && routes.Size() == 5);
+
+        // Через неконстантный итератор меняются значения, а ключи доступны только для чтения
+        static_assert(!std::is_assignable_v<decltype((routes.begin()->first)), std::string>);
+        static_assert(!std::is_assignable_v<decltype(((*routes.begin()).first)), std::string>);
+        for (auto [key, value] : routes) {
+            value += static_cast<int>(key.size());
+        }
+        assert(routes.At("a") == 3 && routes.At("b") == 201);
+        routes.Erase(routes.Find("0"));
+        assert(routes.Size() == 4 && routes.begin()->first == "a");
+    }
+    {
+        Obj::ResetCounters();
+        {
+            FlatMap<int, Obj> objects;
+            objects.TryEmplace(2, 20);
+            objects.TryEmplace(1, 10, "ten");
+            assert(Obj::num_constructed_with_id == 1 && Obj::num_constructed_with_id_and_name == 1);
+            assert(objects.begin()->second.id == 10 && objects.At(2).id == 20);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Значение вставляется из ссылки на элемент той же таблицы, который сдвигается вставкой
+        const std::string long_value(40, 'v');
+        FlatMap<int, std::string> map{{1, "one"}, {3, long_value}, {5, "five"}};
+        // Вместимости хватает, поэтому хвост сдвигается на месте
+        map.Reserve(16);
+        assert(map.TryEmplace(2, map.At(3)).second && map.At(2) == long_value);
+        assert(map.InsertOrAssign(4, map.At(3)).second && map.At(4) == long_value);
+        assert(!map.InsertOrAssign(1, map.At(5)).second && map.At(1) == "five");
+        assert(map.Insert(*map.Find(3)).second == false && map.At(3) == long_value);
+        FlatSet<std::string> set{"a", long_value, "z"};
+        set.Reserve(16);
+        assert(set.Insert(*set.Find("a") + "b").second && set.Contains("ab") && set.Contains(long_value));
+        map[0] = map.At(4);
+        assert(map.At(0) == long_value && map.Size() == 6);
+    }
+    {
+        // Как и std::map, принимает указатель на функцию сравнения
+        using Compare = bool (*)(int, int);
+        const Compare descending = [](int lhs, int rhs) {
+            return lhs > rhs;
+        };
+        FlatMap<int, int, Compare> map({{1, 10}, {3, 30}, {2, 20}}, descending);
+        assert(map.begin()->first == 3 && map.At(2) == 20);
+        assert(map.TryEmplace(4, 40).second && map.begin()->first == 4 && map.Find(5) == map.end());
+        FlatSet<int, Compare> set({1, 3, 2}, descending);
+        assert(*set.begin() == 3 && set.Contains(1));
+    }
+}
+
 int main() {
     try {
         Test1();
@@ -387,6 +2355,34 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+// Аллокатор поверх malloc/realloc. Сообщает реальный размер выделенного блока через allocate_at_least,
+// а reallocate позволяет расширять блок на месте. Крупные блоки glibc переносит через mremap без копирования.
+// Вектор пользуется reallocate только для побайтово переносимых элементов
+template <typename T>
+class MallocAllocator {
+	static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not honour over-aligned types");
+
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	struct AllocationResult {
+		T* ptr;
+		size_t count;
+	};
+
+	MallocAllocator() = default;
+
+	template <typename U>
+	MallocAllocator(const MallocAllocator<U>&) noexcept {
+	}
+
+	T* allocate(size_t n) {
+		return allocate_at_least(n).ptr;
+	}
+
+	AllocationResult allocate_at_least(size_t n) {
+		CheckSize(n);
+		void* ptr = std::malloc(n * sizeof(T));
+		if (ptr == nullptr) {
+			throw std::bad_alloc();
+		}
+		return { static_cast<T*>(ptr), UsableCount(ptr, n) };
+	}
+
+	// Изменяет размер блока p с old_n до new_n элементов. Содержимое переносится побайтово.
+	// При ошибке выбрасывает std::bad_alloc, а блок p остаётся действительным
+	AllocationResult reallocate(T* p, size_t /*old_n*/, size_t new_n) {
+		CheckSize(new_n);
+		void* ptr = std::realloc(p, new_n * sizeof(T));
+		if (ptr == nullptr) {
+			throw std::bad_alloc();
+		}
+		return { static_cast<T*>(ptr), UsableCount(ptr, new_n) };
+	}
+
+	void deallocate(T* p, size_t /*n*/) noexcept {
+		std::free(p);
+	}
+
+	template <typename U>
+	bool operator==(const MallocAllocator<U>&) const noexcept {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const MallocAllocator<U>&) const noexcept {
+		return false;
+	}
+
+private:
+	// Размер блока в байтах не должен переполнять size_t, иначе malloc выделил бы меньший блок
+	static void CheckSize(size_t n) {
+		if (n > static_cast<size_t>(-1) / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+	}
+
+	// Количество элементов, которые поместятся в блок ptr, выделенный под requested элементов
+	static size_t UsableCount(void* ptr, size_t requested) noexcept {
+#if defined(_MSC_VER)
+		const size_t usable = _msize(ptr);
+#elif defined(__APPLE__)
+		const size_t usable = malloc_size(ptr);
+#else
+		const size_t usable = malloc_usable_size(ptr);
+#endif
+		const size_t count = usable / sizeof(T);
+		return count > requested ? count : requested;
+	}
+};
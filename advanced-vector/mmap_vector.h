@@ -0,0 +1,254 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+
+#if !__has_include(<sys/mman.h>)
+#error "MmapVector requires POSIX mmap"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Подсказки ядру о порядке обращения к страницам (madvise)
+enum class AccessPattern {
+	NORMAL,
+	SEQUENTIAL,
+	RANDOM,
+	// Заранее прочитать страницы в кэш
+	WILL_NEED,
+};
+
+// Вектор, элементы которого хранятся в файле, отображённом в память (POSIX mmap с MAP_SHARED).
+// Файл содержит только сами элементы без заголовка, поэтому открытие не копирует и не разбирает данные:
+// страницы читаются при первом обращении и разделяются между всеми процессами, отобразившими тот же файл.
+// При росте файл удлиняется через ftruncate, а отображение — через mremap (на Linux), поэтому, как и у Vector,
+// ссылки на элементы становятся недействительными. Пока файл открыт на запись, его длина равна вместимости,
+// а при закрытии обрезается до числа элементов. Ошибки системных вызовов выбрасываются как std::system_error.
+// MmapVector<const T> открывает существующий файл только для чтения: изменить его элементы или размер
+// не даст компилятор, а не сбой при записи в защищённую страницу
+template <typename T>
+class MmapVector {
+	using Element = std::remove_const_t<T>;
+	static_assert(std::is_trivially_copyable_v<Element>, "MmapVector stores elements as raw file bytes");
+
+	static constexpr bool READ_ONLY = std::is_const_v<T>;
+
+public:
+	using iterator = T*;
+	using const_iterator = const Element*;
+
+	iterator begin() noexcept {
+		return data_;
+	}
+	iterator end() noexcept {
+		return data_ + size_;
+	}
+	const_iterator begin() const noexcept {
+		return data_;
+	}
+	const_iterator end() const noexcept {
+		return data_ + size_;
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	MmapVector() = default;
+
+	// Файл, открываемый на запись, создаётся, если его нет; открываемый на чтение должен существовать
+	explicit MmapVector(const std::string& path) {
+		fd_ = READ_ONLY ? ::open(path.c_str(), O_RDONLY) : ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd_ < 0) {
+			ThrowSystemError("open " + path);
+		}
+		try {
+			struct stat file_stat;
+			if (::fstat(fd_, &file_stat) != 0) {
+				ThrowSystemError("fstat " + path);
+			}
+			const size_t bytes = static_cast<size_t>(file_stat.st_size);
+			if (bytes % sizeof(Element) != 0) {
+				throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+					path + " size is not a multiple of the element size");
+			}
+			Map(bytes / sizeof(Element));
+			size_ = capacity_;
+		}
+		catch (...) {
+			::close(fd_);
+			throw;
+		}
+	}
+
+	MmapVector(const MmapVector&) = delete;
+	MmapVector& operator=(const MmapVector&) = delete;
+
+	MmapVector(MmapVector&& other) noexcept {
+		Swap(other);
+	}
+
+	MmapVector& operator=(MmapVector&& rhs) noexcept {
+		if (this != &rhs) {
+			MmapVector rhs_moved(std::move(rhs));
+			Swap(rhs_moved);
+		}
+		return *this;
+	}
+
+	void Swap(MmapVector& other) noexcept {
+		std::swap(fd_, other.fd_);
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return capacity_;
+	}
+
+	const Element* Data() const noexcept {
+		return data_;
+	}
+
+	const Element& operator[](size_t index) const noexcept {
+		assert(index < size_);
+		return data_[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return data_[index];
+	}
+
+	// Удлиняет файл до new_capacity элементов
+	void Reserve(size_t new_capacity) {
+		static_assert(!READ_ONLY, "MmapVector<const T> cannot grow");
+		if (new_capacity <= capacity_) {
+			return;
+		}
+		if (::ftruncate(fd_, static_cast<off_t>(new_capacity * sizeof(Element))) != 0) {
+			ThrowSystemError("ftruncate");
+		}
+		Map(new_capacity);
+	}
+
+	void PushBack(const Element& value) {
+		static_assert(!READ_ONLY, "MmapVector<const T> cannot grow");
+		if (size_ == capacity_) {
+			// Отображение может переехать, поэтому значение копируется заранее
+			const Element value_copy(value);
+			Reserve(size_ == 0 ? std::max<size_t>(1, INITIAL_BYTES / sizeof(Element)) : size_ * 2);
+			data_[size_++] = value_copy;
+		}
+		else {
+			data_[size_++] = value;
+		}
+	}
+
+	void PopBack() noexcept {
+		static_assert(!READ_ONLY, "MmapVector<const T> cannot shrink");
+		assert(size_ != 0);
+		--size_;
+	}
+
+	void Advise(AccessPattern pattern) {
+		if (data_ == nullptr) {
+			return;
+		}
+		int advice = MADV_NORMAL;
+		switch (pattern) {
+		case AccessPattern::SEQUENTIAL:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case AccessPattern::RANDOM:
+			advice = MADV_RANDOM;
+			break;
+		case AccessPattern::WILL_NEED:
+			advice = MADV_WILLNEED;
+			break;
+		case AccessPattern::NORMAL:
+			break;
+		}
+		if (::madvise(Address(), capacity_ * sizeof(Element), advice) != 0) {
+			ThrowSystemError("madvise");
+		}
+	}
+
+	// Дожидается записи изменённых страниц в файл
+	void Sync() {
+		if (data_ != nullptr && ::msync(Address(), capacity_ * sizeof(Element), MS_SYNC) != 0) {
+			ThrowSystemError("msync");
+		}
+	}
+
+	~MmapVector() {
+		if (data_ != nullptr) {
+			::munmap(Address(), capacity_ * sizeof(Element));
+		}
+		if (fd_ >= 0) {
+			if constexpr (!READ_ONLY) {
+				// Неиспользованная вместимость не должна остаться в файле
+				[[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(size_ * sizeof(Element)));
+			}
+			::close(fd_);
+		}
+	}
+
+private:
+	// Файл при первом росте удлиняется сразу на несколько страниц
+	static constexpr size_t INITIAL_BYTES = 64 << 10;
+
+	[[noreturn]] static void ThrowSystemError(const std::string& what) {
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	// Адрес отображения для системных вызовов, которые принимают void*
+	void* Address() const noexcept {
+		return const_cast<Element*>(data_);
+	}
+
+	// Отображает первые capacity элементов файла, сохраняя уже отображённые страницы
+	void Map(size_t capacity) {
+		const size_t bytes = capacity * sizeof(Element);
+		void* address = MAP_FAILED;
+		if (bytes == 0) {
+			return;
+		}
+		if (data_ == nullptr) {
+			const int protection = READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+			address = ::mmap(nullptr, bytes, protection, MAP_SHARED, fd_, 0);
+		}
+		else {
+#ifdef __linux__
+			address = ::mremap(Address(), capacity_ * sizeof(Element), bytes, MREMAP_MAYMOVE);
+#else
+			address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+			if (address != MAP_FAILED) {
+				::munmap(Address(), capacity_ * sizeof(Element));
+			}
+#endif
+		}
+		if (address == MAP_FAILED) {
+			ThrowSystemError("mmap");
+		}
+		data_ = static_cast<T*>(address);
+		capacity_ = capacity;
+	}
+
+	int fd_ = -1;
+	T* data_ = nullptr;
+	size_t size_ = 0;
+	size_t capacity_ = 0;
+};
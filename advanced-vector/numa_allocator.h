@@ -0,0 +1,206 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define VECTOR_NUMA_LINUX 1
+#else
+#define VECTOR_NUMA_LINUX 0
+#endif
+
+// Способ размещения страниц буфера по узлам NUMA
+enum class NumaPolicy {
+	// Страница попадает на узел потока, первым записавшего в неё (first touch)
+	LOCAL,
+	// Страницы распределяются по всем узлам по очереди, чтобы поровну делить их пропускную способность
+	INTERLEAVE,
+	// Все страницы размещаются на одном узле
+	BIND,
+};
+
+struct NumaPlacement {
+	static NumaPlacement Local() noexcept {
+		return { NumaPolicy::LOCAL, 0 };
+	}
+
+	static NumaPlacement Interleave() noexcept {
+		return { NumaPolicy::INTERLEAVE, 0 };
+	}
+
+	static NumaPlacement Bind(int node) noexcept {
+		return { NumaPolicy::BIND, node };
+	}
+
+	NumaPolicy policy = NumaPolicy::LOCAL;
+	// Узел для BIND
+	int node = 0;
+};
+
+// Буферы меньшего размера выделяются через operator new: размещение по узлам задаётся для целых страниц
+// и не окупает системных вызовов
+inline constexpr size_t NUMA_MIN_ALLOCATION = size_t{1} << 20;
+
+namespace numa_detail {
+
+// Узлы задаются 64-битной маской, поэтому поддерживаются узлы 0–63
+inline constexpr int MAX_NODES = 64;
+
+inline size_t PageSize() noexcept {
+#if VECTOR_NUMA_LINUX
+	static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+	return page_size;
+#else
+	return 4096;
+#endif
+}
+
+// Выделяет страницы под bytes байт и назначает им политику размещения. Сами страницы выделяются ядром
+// при первой записи, поэтому при LOCAL они попадают на узел потока, который создаёт элементы
+inline void* MapPages(size_t bytes, NumaPlacement placement) {
+#if VECTOR_NUMA_LINUX
+	void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (address == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+	if (placement.policy == NumaPolicy::LOCAL) {
+		return address;
+	}
+	// Значения MPOL_BIND и MPOL_INTERLEAVE из <numaif.h>, который требует libnuma
+	constexpr int MPOL_BIND_MODE = 2;
+	constexpr int MPOL_INTERLEAVE_MODE = 3;
+	uint64_t nodes = ~uint64_t{0};
+	int mode = MPOL_INTERLEAVE_MODE;
+	if (placement.policy == NumaPolicy::BIND) {
+		if (placement.node < 0 || placement.node >= MAX_NODES) {
+			::munmap(address, bytes);
+			throw std::system_error(std::make_error_code(std::errc::invalid_argument), "NUMA node out of range");
+		}
+		nodes = uint64_t{1} << placement.node;
+		mode = MPOL_BIND_MODE;
+	}
+	// Ядро читает maxnode - 1 бит маски
+	if (::syscall(SYS_mbind, address, bytes, mode, &nodes, MAX_NODES + 1, 0) != 0 && errno != ENOSYS) {
+		const int error = errno;
+		::munmap(address, bytes);
+		throw std::system_error(error, std::generic_category(), "mbind");
+	}
+	return address;
+#else
+	(void)placement;
+	return operator new(bytes);
+#endif
+}
+
+inline void UnmapPages(void* address, size_t bytes) noexcept {
+#if VECTOR_NUMA_LINUX
+	::munmap(address, bytes);
+#else
+	(void)bytes;
+	operator delete(address);
+#endif
+}
+
+}  // namespace numa_detail
+
+// Узел NUMA, на котором размещена страница с адресом address, или -1, если это неизвестно
+// (страница ещё не выделена или система не поддерживает NUMA)
+inline int NumaNodeOf(const void* address) noexcept {
+#if VECTOR_NUMA_LINUX
+	// MPOL_F_NODE | MPOL_F_ADDR
+	constexpr unsigned long FLAGS = 3;
+	int node = -1;
+	if (::syscall(SYS_get_mempolicy, &node, nullptr, 0, address, FLAGS) != 0) {
+		return -1;
+	}
+	return node;
+#else
+	(void)address;
+	return -1;
+#endif
+}
+
+// Аллокатор, размещающий крупные буферы (от NUMA_MIN_ALLOCATION байт) по узлам NUMA согласно NumaPlacement.
+// Крупные буферы выделяются целыми страницами через mmap, и через allocate_at_least вектор получает
+// всю вместимость последней страницы. При LOCAL размещение определяется тем, какие потоки первыми
+// записывают в страницы, поэтому большие векторы стоит создавать через ParallelConstruct (parallel_vector.h)
+// теми же частями, которыми их потом обрабатывают потоки.
+// Политика не влияет на освобождение, поэтому все экземпляры равны
+template <typename T>
+class NumaAllocator {
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Small buffers use the default new alignment");
+
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	struct AllocationResult {
+		T* ptr;
+		size_t count;
+	};
+
+	NumaAllocator() = default;
+
+	explicit NumaAllocator(NumaPlacement placement) noexcept
+		: placement_(placement) {
+	}
+
+	template <typename U>
+	NumaAllocator(const NumaAllocator<U>& other) noexcept
+		: placement_(other.GetPlacement()) {
+	}
+
+	NumaPlacement GetPlacement() const noexcept {
+		return placement_;
+	}
+
+	T* allocate(size_t n) {
+		return allocate_at_least(n).ptr;
+	}
+
+	AllocationResult allocate_at_least(size_t n) {
+		if (n > static_cast<size_t>(-1) / sizeof(T) - numa_detail::PageSize()) {
+			throw std::bad_array_new_length();
+		}
+		const size_t bytes = n * sizeof(T);
+		if (bytes < NUMA_MIN_ALLOCATION) {
+			return { static_cast<T*>(operator new(bytes)), n };
+		}
+		const size_t mapped = RoundToPages(bytes);
+		return { static_cast<T*>(numa_detail::MapPages(mapped, placement_)), mapped / sizeof(T) };
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		const size_t bytes = n * sizeof(T);
+		if (bytes < NUMA_MIN_ALLOCATION) {
+			operator delete(p);
+		}
+		else {
+			numa_detail::UnmapPages(p, RoundToPages(bytes));
+		}
+	}
+
+	template <typename U>
+	bool operator==(const NumaAllocator<U>&) const noexcept {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const NumaAllocator<U>&) const noexcept {
+		return false;
+	}
+
+private:
+	static size_t RoundToPages(size_t bytes) noexcept {
+		const size_t page_size = numa_detail::PageSize();
+		return (bytes + page_size - 1) / page_size * page_size;
+	}
+
+	NumaPlacement placement_;
+};
@@ -0,0 +1,186 @@
+#pragma once
+#include "vector.h"
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Параллельное копирование, создание и уничтожение очень больших векторов. Диапазон элементов
+// делится на части по числу потоков, каждая часть обрабатывается в своём потоке, а первая — в вызывающем.
+// Гарантии безопасности исключений такие же, как у соответствующих конструкторов Vector: если создание
+// элемента в любой из частей выбрасывает исключение, уничтожаются ровно те элементы, которые успели
+// создать, буфер освобождается, а исключение передаётся вызывающему коду
+
+// Части меньшего размера не окупают запуск потока
+inline constexpr size_t PARALLEL_MIN_CHUNK_SIZE = size_t{1} << 14;
+
+inline size_t DefaultThreadCount() noexcept {
+	const unsigned threads = std::thread::hardware_concurrency();
+	return threads == 0 ? 1 : threads;
+}
+
+namespace parallel_detail {
+
+inline size_t ChunkCount(size_t size, size_t threads) noexcept {
+	return std::max<size_t>(1, std::min(threads, size / PARALLEL_MIN_CHUNK_SIZE));
+}
+
+inline size_t ChunkBegin(size_t size, size_t chunks, size_t chunk) noexcept {
+	// Деление в два шага не переполняется даже для очень больших size
+	return size / chunks * chunk + size % chunks * chunk / chunks;
+}
+
+// Выполняет function(chunk, begin, end) для каждой из chunks частей диапазона [0, size).
+// Если потоки не удаётся запустить, оставшиеся части выполняются в вызывающем потоке.
+// Возвращает первое исключение, выброшенное function, после завершения всех частей
+template <typename Function>
+std::exception_ptr RunChunks(size_t size, size_t chunks, Function& function) noexcept {
+	std::exception_ptr error;
+	std::mutex error_mutex;
+	const auto run = [&](size_t chunk) noexcept {
+		try {
+			function(chunk, ChunkBegin(size, chunks, chunk), ChunkBegin(size, chunks, chunk + 1));
+		}
+		catch (...) {
+			std::lock_guard lock(error_mutex);
+			if (!error) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	Vector<std::thread> workers;
+	size_t launched = 1;
+	try {
+		workers.Reserve(chunks - 1);
+		for (; launched != chunks; ++launched) {
+			workers.EmplaceBack(run, launched);
+		}
+	}
+	catch (...) {
+	}
+	run(0);
+	for (size_t chunk = launched; chunk != chunks; ++chunk) {
+		run(chunk);
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	return error;
+}
+
+// Создаёт элементы буфера data по частям функцией construct(begin, end), которая сама уничтожает
+// созданные ею элементы при исключении. При ошибке в любой части уничтожает элементы успешных частей
+template <typename T, typename Construct>
+void ConstructChunks(T* data, size_t size, size_t chunks, Construct construct) {
+	Vector<unsigned char> constructed(chunks);
+	auto function = [&](size_t chunk, size_t begin, size_t end) {
+		construct(begin, end);
+		constructed[chunk] = 1;
+	};
+	if (std::exception_ptr error = RunChunks(size, chunks, function)) {
+		for (size_t chunk = 0; chunk != chunks; ++chunk) {
+			if (constructed[chunk]) {
+				const size_t begin = ChunkBegin(size, chunks, chunk);
+				std::destroy_n(data + begin, ChunkBegin(size, chunks, chunk + 1) - begin);
+			}
+		}
+		std::rethrow_exception(error);
+	}
+}
+
+}  // namespace parallel_detail
+
+// Аналог Vector(const Vector&), копирующий элементы в threads потоках
+template <typename T, typename Allocator, typename GrowthPolicy>
+Vector<T, Allocator, GrowthPolicy> ParallelCopy(const Vector<T, Allocator, GrowthPolicy>& other,
+	size_t threads = DefaultThreadCount()) {
+	using AllocTraits = std::allocator_traits<Allocator>;
+	const Allocator alloc = AllocTraits::select_on_container_copy_construction(other.GetAllocator());
+	const size_t size = other.Size();
+	const size_t chunks = parallel_detail::ChunkCount(size, threads);
+	if (chunks == 1) {
+		return Vector<T, Allocator, GrowthPolicy>(other, alloc);
+	}
+	RawMemory<T, Allocator> memory(size, alloc);
+	T* data = memory.GetAddress();
+	parallel_detail::ConstructChunks(data, size, chunks, [&](size_t begin, size_t end) {
+		std::uninitialized_copy(other.begin() + begin, other.begin() + end, data + begin);
+	});
+	Vector<T, Allocator, GrowthPolicy> result(alloc);
+	result.Adopt(std::move(memory), size);
+	return result;
+}
+
+// Выполняет function(begin, end) для частей диапазона [0, size) в threads потоках. Части те же, что
+// у ParallelConstruct(size, threads), поэтому с тем же числом потоков каждая часть вектора обрабатывается
+// так же, как создавалась. Первое исключение из function передаётся вызывающему коду
+template <typename Function>
+void ParallelFor(size_t size, size_t threads, Function function) {
+	auto run = [&function](size_t /*chunk*/, size_t begin, size_t end) {
+		function(begin, end);
+	};
+	if (std::exception_ptr error = parallel_detail::RunChunks(size, parallel_detail::ChunkCount(size, threads), run)) {
+		std::rethrow_exception(error);
+	}
+}
+
+// Аналог Vector(size), создающий элементы в threads потоках
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+Vector<T, Allocator, GrowthPolicy> ParallelConstruct(size_t size, size_t threads = DefaultThreadCount(),
+	const Allocator& alloc = Allocator()) {
+	const size_t chunks = parallel_detail::ChunkCount(size, threads);
+	if (chunks == 1) {
+		return Vector<T, Allocator, GrowthPolicy>(size, alloc);
+	}
+	RawMemory<T, Allocator> memory(size, alloc);
+	T* data = memory.GetAddress();
+	parallel_detail::ConstructChunks(data, size, chunks, [data](size_t begin, size_t end) {
+		std::uninitialized_value_construct_n(data + begin, end - begin);
+	});
+	Vector<T, Allocator, GrowthPolicy> result(alloc);
+	result.Adopt(std::move(memory), size);
+	return result;
+}
+
+// Аналог Resize, создающий новые элементы в threads потоках. Каждая страница новой части буфера
+// впервые записывается потоком, создающим её элементы, поэтому с NumaAllocator и политикой LOCAL
+// она размещается на его узле. Существующие элементы при росте буфера переносятся в вызывающем потоке.
+// Если создание элемента выбросит исключение, вектор сохраняет прежний размер
+template <typename T, typename Allocator, typename GrowthPolicy>
+void ParallelResize(Vector<T, Allocator, GrowthPolicy>& vector, size_t new_size, size_t threads = DefaultThreadCount()) {
+	const size_t size = vector.Size();
+	const size_t chunks = parallel_detail::ChunkCount(new_size - std::min(size, new_size), threads);
+	if (new_size <= size || chunks == 1) {
+		vector.Resize(new_size);
+		return;
+	}
+	vector.Reserve(new_size);
+	auto [memory, old_size] = vector.Release();
+	T* data = memory.GetAddress() + old_size;
+	try {
+		parallel_detail::ConstructChunks(data, new_size - old_size, chunks, [data](size_t begin, size_t end) {
+			std::uninitialized_value_construct_n(data + begin, end - begin);
+		});
+	}
+	catch (...) {
+		vector.Adopt(std::move(memory), old_size);
+		throw;
+	}
+	vector.Adopt(std::move(memory), new_size);
+}
+
+// Уничтожает элементы вектора в threads потоках и освобождает его память. Вектор остаётся пустым
+template <typename T, typename Allocator, typename GrowthPolicy>
+void ParallelDestroy(Vector<T, Allocator, GrowthPolicy>& vector, size_t threads = DefaultThreadCount()) noexcept {
+	auto [memory, size] = vector.Release();
+	if constexpr (!std::is_trivially_destructible_v<T>) {
+		T* data = memory.GetAddress();
+		auto destroy = [data](size_t /*chunk*/, size_t begin, size_t end) noexcept {
+			std::destroy_n(data + begin, end - begin);
+		};
+		parallel_detail::RunChunks(size, parallel_detail::ChunkCount(size, threads), destroy);
+	}
+}
@@ -0,0 +1,315 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+// Ограничения кэшей BufferPool. Изменение вступает в силу при следующих выделениях и освобождениях
+struct PoolLimits {
+	// Объём блоков одного класса размера, который может храниться в кэше потока
+	size_t thread_cache_bytes = size_t{1} << 18;
+	// Объём блоков одного класса в общем кэше, через который блоки переходят между потоками
+	size_t central_cache_bytes = size_t{1} << 22;
+	// Сколько блоков переносится между кэшем потока и общим кэшем за одно взятие блокировки
+	size_t transfer_batch = 32;
+};
+
+// Счётчики обращений к пулу из текущего потока
+struct PoolStats {
+	// Блок выдан из кэша потока без блокировок
+	size_t thread_cache_hits = 0;
+	// Блок взят из общего кэша
+	size_t central_cache_hits = 0;
+	// Блок выделен через operator new
+	size_t system_allocations = 0;
+	// Блок возвращён через operator delete
+	size_t system_frees = 0;
+};
+
+// Пул буферов, разбитых на классы размеров — степени двойки от MIN_BLOCK_SIZE до MAX_BLOCK_SIZE байт.
+// У каждого потока свой кэш освобождённых блоков, поэтому короткоживущие векторы получают и возвращают
+// буферы без блокировок и без обращения к operator new. Блок, освобождённый в другом потоке, попадает
+// в кэш освободившего потока; излишки кэша переносятся пачками в общий кэш, из которого берёт блоки поток,
+// у которого кэш опустел. При завершении потока его кэш целиком возвращается в общий.
+// Запросы крупнее MAX_BLOCK_SIZE передаются operator new без округления
+class BufferPool {
+public:
+	static constexpr size_t MIN_BLOCK_SIZE = 16;
+	static constexpr size_t MAX_BLOCK_SIZE = size_t{1} << 20;
+
+	// Выделенный блок и его размер в байтах. Размер может превышать запрошенный
+	struct Block {
+		void* ptr;
+		size_t size;
+	};
+
+	// Пул не уничтожается, чтобы векторы в статических объектах могли освобождать память при завершении программы
+	static BufferPool& Global() noexcept {
+		static BufferPool* pool = new BufferPool;
+		return *pool;
+	}
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	Block Allocate(size_t bytes) {
+		if (bytes > MAX_BLOCK_SIZE) {
+			++Stats().system_allocations;
+			return { operator new(bytes), bytes };
+		}
+		const size_t size_class = SizeClass(bytes);
+		ThreadCache* cache = LocalCache();
+		if (cache != nullptr) {
+			if (void* block = cache->lists[size_class].Pop()) {
+				++cache->stats.thread_cache_hits;
+				return { block, ClassSize(size_class) };
+			}
+			if (void* block = RefillFromCentral(*cache, size_class)) {
+				++cache->stats.central_cache_hits;
+				return { block, ClassSize(size_class) };
+			}
+		}
+		++Stats().system_allocations;
+		return { operator new(ClassSize(size_class)), ClassSize(size_class) };
+	}
+
+	// Возвращает блок размера size, полученного из Allocate (или меньшего, но с тем же классом размера)
+	void Deallocate(void* ptr, size_t size) noexcept {
+		if (size > MAX_BLOCK_SIZE) {
+			++Stats().system_frees;
+			operator delete(ptr);
+			return;
+		}
+		const size_t size_class = SizeClass(size);
+		ThreadCache* cache = LocalCache();
+		if (cache == nullptr) {
+			// Кэш потока уже уничтожен, например при освобождении статического вектора
+			FreeList list;
+			list.Push(ptr);
+			ReleaseToCentral(list, size_class, 1);
+			return;
+		}
+		FreeList& list = cache->lists[size_class];
+		list.Push(ptr);
+		if (list.count * ClassSize(size_class) > thread_cache_bytes_.load(std::memory_order_relaxed)) {
+			ReleaseToCentral(list, size_class, std::max<size_t>(1, transfer_batch_.load(std::memory_order_relaxed)));
+		}
+	}
+
+	void SetLimits(const PoolLimits& limits) noexcept {
+		thread_cache_bytes_.store(limits.thread_cache_bytes, std::memory_order_relaxed);
+		central_cache_bytes_.store(limits.central_cache_bytes, std::memory_order_relaxed);
+		transfer_batch_.store(limits.transfer_batch, std::memory_order_relaxed);
+	}
+
+	PoolLimits GetLimits() const noexcept {
+		PoolLimits limits;
+		limits.thread_cache_bytes = thread_cache_bytes_.load(std::memory_order_relaxed);
+		limits.central_cache_bytes = central_cache_bytes_.load(std::memory_order_relaxed);
+		limits.transfer_batch = transfer_batch_.load(std::memory_order_relaxed);
+		return limits;
+	}
+
+	// Счётчики текущего потока
+	static PoolStats& Stats() noexcept {
+		static thread_local PoolStats stats;
+		return stats;
+	}
+
+	// Возвращает в общий кэш все блоки кэша текущего потока
+	void FlushThreadCache() noexcept {
+		if (ThreadCache* cache = LocalCache()) {
+			FlushCache(*cache);
+		}
+	}
+
+	// Освобождает через operator delete все блоки общего кэша
+	void ReleaseCentralCache() noexcept {
+		for (size_t size_class = 0; size_class != CLASS_COUNT; ++size_class) {
+			FreeList list;
+			{
+				std::lock_guard lock(central_[size_class].mutex);
+				std::swap(list, central_[size_class].list);
+			}
+			while (void* block = list.Pop()) {
+				++Stats().system_frees;
+				operator delete(block);
+			}
+		}
+	}
+
+private:
+	static constexpr size_t MIN_BLOCK_LOG = 4;
+	static_assert(MIN_BLOCK_SIZE == size_t{1} << MIN_BLOCK_LOG && MIN_BLOCK_SIZE >= sizeof(void*));
+	static constexpr size_t CLASS_COUNT = 17;
+	static_assert(MAX_BLOCK_SIZE == MIN_BLOCK_SIZE << (CLASS_COUNT - 1));
+
+	// Односвязный список свободных блоков. Указатель на следующий блок хранится в самом блоке
+	struct FreeList {
+		void Push(void* block) noexcept {
+			*static_cast<void**>(block) = head;
+			head = block;
+			++count;
+		}
+
+		void* Pop() noexcept {
+			void* block = head;
+			if (block != nullptr) {
+				head = *static_cast<void**>(block);
+				--count;
+			}
+			return block;
+		}
+
+		void* head = nullptr;
+		size_t count = 0;
+	};
+
+	struct ThreadCache {
+		~ThreadCache() {
+			FlushCache(*this);
+			destroyed = true;
+		}
+
+		FreeList lists[CLASS_COUNT];
+		PoolStats& stats = Stats();
+		// Тривиальный флаг остаётся доступным и после уничтожения кэша
+		static inline thread_local bool destroyed = false;
+	};
+
+	struct CentralList {
+		std::mutex mutex;
+		FreeList list;
+	};
+
+	BufferPool() = default;
+
+	// Наименьший класс, блоки которого вмещают bytes байт
+	static size_t SizeClass(size_t bytes) noexcept {
+		if (bytes <= MIN_BLOCK_SIZE) {
+			return 0;
+		}
+#if defined(__GNUC__) || defined(__clang__)
+		return sizeof(unsigned long long) * CHAR_BIT - __builtin_clzll(bytes - 1) - MIN_BLOCK_LOG;
+#else
+		size_t size_class = 0;
+		while (ClassSize(size_class) < bytes) {
+			++size_class;
+		}
+		return size_class;
+#endif
+	}
+
+	static constexpr size_t ClassSize(size_t size_class) noexcept {
+		return MIN_BLOCK_SIZE << size_class;
+	}
+
+	static ThreadCache* LocalCache() noexcept {
+		if (ThreadCache::destroyed) {
+			return nullptr;
+		}
+		static thread_local ThreadCache cache;
+		return &cache;
+	}
+
+	static void FlushCache(ThreadCache& cache) noexcept {
+		BufferPool& pool = Global();
+		for (size_t size_class = 0; size_class != CLASS_COUNT; ++size_class) {
+			pool.ReleaseToCentral(cache.lists[size_class], size_class, cache.lists[size_class].count);
+		}
+	}
+
+	// Забирает из общего кэша до transfer_batch блоков и возвращает один из них
+	void* RefillFromCentral(ThreadCache& cache, size_t size_class) {
+		const size_t batch = std::max<size_t>(1, transfer_batch_.load(std::memory_order_relaxed));
+		FreeList& local = cache.lists[size_class];
+		CentralList& central = central_[size_class];
+		std::lock_guard lock(central.mutex);
+		for (size_t i = 0; i != batch; ++i) {
+			void* block = central.list.Pop();
+			if (block == nullptr) {
+				break;
+			}
+			local.Push(block);
+		}
+		return local.Pop();
+	}
+
+	// Переносит count блоков из list в общий кэш. Блоки сверх его предела освобождаются
+	void ReleaseToCentral(FreeList& list, size_t size_class, size_t count) noexcept {
+		const size_t limit = central_cache_bytes_.load(std::memory_order_relaxed) / ClassSize(size_class);
+		FreeList surplus;
+		{
+			CentralList& central = central_[size_class];
+			std::lock_guard lock(central.mutex);
+			for (size_t i = 0; i != count; ++i) {
+				void* block = list.Pop();
+				if (block == nullptr) {
+					break;
+				}
+				(central.list.count < limit ? central.list : surplus).Push(block);
+			}
+		}
+		while (void* block = surplus.Pop()) {
+			++Stats().system_frees;
+			operator delete(block);
+		}
+	}
+
+	std::atomic<size_t> thread_cache_bytes_{ PoolLimits().thread_cache_bytes };
+	std::atomic<size_t> central_cache_bytes_{ PoolLimits().central_cache_bytes };
+	std::atomic<size_t> transfer_batch_{ PoolLimits().transfer_batch };
+	CentralList central_[CLASS_COUNT];
+};
+
+// Аллокатор, берущий буферы из BufferPool::Global(). Через allocate_at_least сообщает вектору полный
+// размер блока, поэтому вместимость округляется вверх до класса размера, и следующий Reserve того же порядка
+// получит тот же блок из кэша. Все экземпляры равны: блок можно освободить в любом потоке
+template <typename T>
+class PoolAllocator {
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Pool blocks use the default new alignment");
+
+public:
+	using value_type = T;
+	using is_always_equal = std::true_type;
+
+	struct AllocationResult {
+		T* ptr;
+		size_t count;
+	};
+
+	PoolAllocator() = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {
+	}
+
+	T* allocate(size_t n) {
+		return allocate_at_least(n).ptr;
+	}
+
+	AllocationResult allocate_at_least(size_t n) {
+		if (n > static_cast<size_t>(-1) / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		const BufferPool::Block block = BufferPool::Global().Allocate(n * sizeof(T));
+		return { static_cast<T*>(block.ptr), block.size / sizeof(T) };
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		BufferPool::Global().Deallocate(p, n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const noexcept {
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>&) const noexcept {
+		return false;
+	}
+};
@@ -0,0 +1,596 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if __has_include(<sys/uio.h>) && __has_include(<unistd.h>)
+#include <cerrno>
+#include <system_error>
+#include <sys/uio.h>
+#include <unistd.h>
+#define VECTOR_SERIALIZATION_POSIX 1
+#else
+#define VECTOR_SERIALIZATION_POSIX 0
+#endif
+
+// Двоичная сериализация Vector. Сообщение состоит из заголовка SerializationHeader и данных элементов.
+// Элементы тривиально копируемых типов записываются одним блоком в порядке байтов процессора, поэтому
+// их можно прочитать одним вызовом прямо в буфер вектора или использовать на месте через DeserializeView.
+// Остальные типы записываются поэлементно через Serializer<T>.
+//
+// Writer — любой тип с методом Write(const void* data, size_t size). Если у него есть и метод
+// WriteGather(const ConstBuffer* buffers, size_t count), заголовок и данные передаются одним вызовом.
+// Reader — любой тип с методом Read(void* data, size_t size), который выбрасывает исключение,
+// если прочитать size байт не удалось
+
+// Ошибка формата: неверная сигнатура или версия, несовпадение размера элемента или контрольной суммы,
+// неожиданный конец данных
+class SerializationError : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Участок памяти для WriteGather
+struct ConstBuffer {
+	const void* data;
+	size_t size;
+};
+
+// Контрольная сумма Флетчера над 64-битными словами: сумма слов и сумма частичных сумм, которая зависит
+// от порядка слов. Данные обрабатываются в LANES независимых полосах одними сложениями, поэтому цикл
+// векторизуется и работает со скоростью чтения памяти. Полосы и хвост сворачиваются перемешиванием FNV-1a.
+// Результат не зависит от того, какими частями переданы данные
+class Checksum {
+public:
+	void Update(const void* data, size_t size) noexcept {
+		if (size == 0) {
+			return;
+		}
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		if (pending_size_ != 0) {
+			const size_t count = std::min(size, BLOCK_SIZE - pending_size_);
+			std::memcpy(pending_ + pending_size_, bytes, count);
+			pending_size_ += count;
+			bytes += count;
+			size -= count;
+			if (pending_size_ != BLOCK_SIZE) {
+				return;
+			}
+			AddBlocks(pending_, BLOCK_SIZE);
+			pending_size_ = 0;
+		}
+		const size_t blocks_end = size - size % BLOCK_SIZE;
+		AddBlocks(bytes, blocks_end);
+		std::memcpy(pending_, bytes + blocks_end, size - blocks_end);
+		pending_size_ = size - blocks_end;
+	}
+
+	uint64_t Value() const noexcept {
+		uint64_t hash = OFFSET_BASIS;
+		for (size_t lane = 0; lane != LANES; ++lane) {
+			hash = Mix(Mix(hash, sums_[lane]), sums_of_sums_[lane]);
+		}
+		for (size_t i = 0; i != pending_size_; ++i) {
+			hash = (hash ^ pending_[i]) * PRIME;
+		}
+		return Mix(hash, pending_size_);
+	}
+
+private:
+	static constexpr size_t LANES = 8;
+	static constexpr size_t BLOCK_SIZE = LANES * sizeof(uint64_t);
+	static constexpr uint64_t OFFSET_BASIS = 0xcbf29ce484222325ULL;
+	static constexpr uint64_t PRIME = 0x100000001b3ULL;
+
+	static uint64_t Mix(uint64_t hash, uint64_t word) noexcept {
+		hash = (hash ^ word) * PRIME;
+		return hash ^ (hash >> 29);
+	}
+
+	void AddBlocks(const unsigned char* bytes, size_t size) noexcept {
+		uint64_t sums[LANES];
+		uint64_t sums_of_sums[LANES];
+		std::memcpy(sums, sums_, sizeof(sums));
+		std::memcpy(sums_of_sums, sums_of_sums_, sizeof(sums_of_sums));
+		for (size_t offset = 0; offset != size; offset += BLOCK_SIZE) {
+			uint64_t words[LANES];
+			std::memcpy(words, bytes + offset, BLOCK_SIZE);
+			for (size_t lane = 0; lane != LANES; ++lane) {
+				sums[lane] += words[lane];
+				sums_of_sums[lane] += sums[lane];
+			}
+		}
+		std::memcpy(sums_, sums, sizeof(sums));
+		std::memcpy(sums_of_sums_, sums_of_sums, sizeof(sums_of_sums));
+	}
+
+	// Ненулевые начальные суммы различают нулевые данные разной длины
+	uint64_t sums_[LANES] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uint64_t sums_of_sums_[LANES] = {};
+	unsigned char pending_[BLOCK_SIZE] = {};
+	size_t pending_size_ = 0;
+};
+
+// Заголовок сообщения. Поле checksum покрывает остальные поля заголовка и данные элементов, а header_checksum —
+// только сам заголовок: его проверяют сразу после чтения, поэтому повреждённые count или payload_size
+// отвергаются до выделения памяти под данные
+struct SerializationHeader {
+	// "AVEC" в порядке байтов процессора: сообщение с другим порядком байтов не пройдёт проверку сигнатуры
+	static constexpr uint32_t MAGIC = 0x43455641;
+	static constexpr uint16_t CURRENT_VERSION = 2;
+	// Данные — образ памяти элементов: count * element_size байт
+	static constexpr uint16_t TRIVIAL_LAYOUT = 1;
+
+	uint32_t magic = MAGIC;
+	uint16_t version = CURRENT_VERSION;
+	uint16_t flags = 0;
+	uint32_t element_size = 0;
+	uint32_t header_checksum = 0;
+	uint64_t count = 0;
+	uint64_t payload_size = 0;
+	uint64_t checksum = 0;
+};
+
+static_assert(sizeof(SerializationHeader) == 40 && std::is_trivially_copyable_v<SerializationHeader>);
+
+// Точка настройки сериализации нетривиальных типов. Специализация должна предоставить
+// static void Write(Writer&, const T&) и static T Read(Reader&)
+template <typename T, typename = void>
+struct Serializer;
+
+// Writer, дописывающий байты в конец Vector<char>. Подходит для подготовки сообщений RPC
+class BufferWriter {
+public:
+	explicit BufferWriter(Vector<char>& buffer) noexcept
+		: buffer_(&buffer) {
+	}
+
+	void Write(const void* data, size_t size) {
+		const size_t offset = buffer_->Size();
+		if (offset + size > buffer_->Capacity()) {
+			// Reserve выделяет ровно запрошенное, поэтому при дописывании малыми частями буфер растёт вдвое
+			buffer_->Reserve(std::max(offset + size, buffer_->Capacity() * 2));
+		}
+		buffer_->ResizeUninitialized(offset + size);
+		if (size != 0) {
+			std::memcpy(buffer_->begin() + offset, data, size);
+		}
+	}
+
+private:
+	Vector<char>* buffer_;
+};
+
+// Reader, последовательно читающий байты из буфера, которым он не владеет
+class BufferReader {
+public:
+	BufferReader(const void* data, size_t size) noexcept
+		: data_(static_cast<const char*>(data))
+		, size_(size) {
+	}
+
+	void Read(void* data, size_t size) {
+		if (size > Remaining()) {
+			throw SerializationError("Unexpected end of buffer");
+		}
+		if (size != 0) {
+			std::memcpy(data, data_ + offset_, size);
+		}
+		offset_ += size;
+	}
+
+	size_t Remaining() const noexcept {
+		return size_ - offset_;
+	}
+
+private:
+	const char* data_;
+	size_t size_;
+	size_t offset_ = 0;
+};
+
+class StreamWriter {
+public:
+	explicit StreamWriter(std::ostream& output) noexcept
+		: output_(&output) {
+	}
+
+	void Write(const void* data, size_t size) {
+		if (!output_->write(static_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+			throw SerializationError("Stream write failed");
+		}
+	}
+
+private:
+	std::ostream* output_;
+};
+
+class StreamReader {
+public:
+	explicit StreamReader(std::istream& input) noexcept
+		: input_(&input) {
+	}
+
+	void Read(void* data, size_t size) {
+		if (!input_->read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+			throw SerializationError("Unexpected end of stream");
+		}
+	}
+
+private:
+	std::istream* input_;
+};
+
+#if VECTOR_SERIALIZATION_POSIX
+// Writer для файлового дескриптора. WriteGather передаёт заголовок и данные одним вызовом writev.
+// Дескриптором владеет вызывающий код. Ошибки write выбрасываются как std::system_error
+class FdWriter {
+public:
+	explicit FdWriter(int fd) noexcept
+		: fd_(fd) {
+	}
+
+	void Write(const void* data, size_t size) {
+		const ConstBuffer buffer{ data, size };
+		WriteGather(&buffer, 1);
+	}
+
+	void WriteGather(const ConstBuffer* buffers, size_t count) {
+		constexpr size_t MAX_BUFFERS = 16;
+		iovec iov[MAX_BUFFERS];
+		while (count != 0) {
+			const size_t batch = std::min(count, MAX_BUFFERS);
+			for (size_t i = 0; i != batch; ++i) {
+				iov[i].iov_base = const_cast<void*>(buffers[i].data);
+				iov[i].iov_len = buffers[i].size;
+			}
+			WriteAll(iov, batch);
+			buffers += batch;
+			count -= batch;
+		}
+	}
+
+private:
+	// writev может записать только часть данных, тогда запись продолжается с места остановки
+	void WriteAll(iovec* iov, size_t count) {
+		while (count != 0) {
+			const ssize_t written = ::writev(fd_, iov, static_cast<int>(count));
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::system_error(errno, std::generic_category(), "writev");
+			}
+			size_t remaining = static_cast<size_t>(written);
+			while (count != 0 && remaining >= iov->iov_len) {
+				remaining -= iov->iov_len;
+				++iov;
+				--count;
+			}
+			if (count != 0) {
+				iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+				iov->iov_len -= remaining;
+			}
+		}
+	}
+
+	int fd_;
+};
+
+class FdReader {
+public:
+	explicit FdReader(int fd) noexcept
+		: fd_(fd) {
+	}
+
+	void Read(void* data, size_t size) {
+		char* bytes = static_cast<char*>(data);
+		while (size != 0) {
+			const ssize_t result = ::read(fd_, bytes, size);
+			if (result < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::system_error(errno, std::generic_category(), "read");
+			}
+			if (result == 0) {
+				throw SerializationError("Unexpected end of file");
+			}
+			bytes += result;
+			size -= static_cast<size_t>(result);
+		}
+	}
+
+private:
+	int fd_;
+};
+#endif
+
+namespace serialization_detail {
+
+template <typename Writer, typename = void>
+struct HasWriteGather : std::false_type {
+};
+
+template <typename Writer>
+struct HasWriteGather<Writer, std::void_t<decltype(std::declval<Writer&>().WriteGather(
+	std::declval<const ConstBuffer*>(), size_t{}))>> : std::true_type {
+};
+
+// Writer, считающий байты и контрольную сумму вместо записи
+class MeasuringWriter {
+public:
+	void Write(const void* data, size_t size) noexcept {
+		checksum_.Update(data, size);
+		size_ += size;
+	}
+
+	const Checksum& GetChecksum() const noexcept {
+		return checksum_;
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+private:
+	Checksum checksum_;
+	size_t size_ = 0;
+};
+
+// Байты заголовка, которые покрывает контрольная сумма
+inline constexpr size_t CHECKED_HEADER_SIZE = offsetof(SerializationHeader, checksum);
+
+// Контрольная сумма всех байтов заголовка, кроме самого header_checksum, свёрнутая до 32 бит
+inline uint32_t HeaderChecksum(const SerializationHeader& header) noexcept {
+	SerializationHeader copy = header;
+	copy.header_checksum = 0;
+	Checksum checksum;
+	checksum.Update(&copy, sizeof(copy));
+	const uint64_t value = checksum.Value();
+	return static_cast<uint32_t>(value ^ (value >> 32));
+}
+
+inline void SealHeader(SerializationHeader& header, const Checksum& payload_checksum) noexcept {
+	header.header_checksum = 0;
+	Checksum checksum;
+	checksum.Update(&header, CHECKED_HEADER_SIZE);
+	const uint64_t payload_value = payload_checksum.Value();
+	checksum.Update(&payload_value, sizeof(payload_value));
+	header.checksum = checksum.Value();
+	header.header_checksum = HeaderChecksum(header);
+}
+
+inline uint64_t PayloadChecksum(const SerializationHeader& header, const void* payload) noexcept {
+	Checksum payload_checksum;
+	payload_checksum.Update(payload, header.payload_size);
+	SerializationHeader sealed = header;
+	SealHeader(sealed, payload_checksum);
+	return sealed.checksum;
+}
+
+template <typename T>
+void CheckHeader(const SerializationHeader& header) {
+	if (header.magic != SerializationHeader::MAGIC) {
+		throw SerializationError("Bad magic or byte order");
+	}
+	if (header.header_checksum != HeaderChecksum(header)) {
+		throw SerializationError("Header checksum mismatch");
+	}
+	if (header.version != SerializationHeader::CURRENT_VERSION) {
+		throw SerializationError("Unsupported version " + std::to_string(header.version));
+	}
+	if (header.element_size != sizeof(T)) {
+		throw SerializationError("Element size mismatch");
+	}
+	constexpr uint16_t expected_flags = std::is_trivially_copyable_v<T> ? SerializationHeader::TRIVIAL_LAYOUT : 0;
+	if (header.flags != expected_flags) {
+		throw SerializationError("Element layout mismatch");
+	}
+	if (expected_flags == SerializationHeader::TRIVIAL_LAYOUT
+		&& (header.count > std::numeric_limits<size_t>::max() / sizeof(T) || header.payload_size != header.count * sizeof(T))) {
+		throw SerializationError("Payload size mismatch");
+	}
+	if (header.payload_size > std::numeric_limits<size_t>::max()) {
+		throw SerializationError("Payload too large");
+	}
+}
+
+template <typename T, typename Writer>
+void WriteElements(const T* data, size_t size, Writer& writer) {
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		writer.Write(data, size * sizeof(T));
+	}
+	else {
+		for (size_t i = 0; i != size; ++i) {
+			Serializer<T>::Write(writer, data[i]);
+		}
+	}
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Reader>
+void ReadElements(Reader& reader, size_t count, Vector<T, Allocator, GrowthPolicy>& result) {
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+			throw SerializationError("Element count too large");
+		}
+		// Типы с инициализаторами членов тривиально копируемы, но не тривиально создаваемы:
+		// их элементы сначала создаются по умолчанию и затем перезаписываются
+		if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>) {
+			result.ResizeUninitialized(count);
+		}
+		else {
+			result.Resize(count);
+		}
+		reader.Read(result.begin(), count * sizeof(T));
+	}
+	else {
+		for (size_t i = 0; i != count; ++i) {
+			result.PushBack(Serializer<T>::Read(reader));
+		}
+	}
+}
+
+}  // namespace serialization_detail
+
+// Вложенные строки записываются длиной и байтами
+template <typename Char, typename Traits, typename StringAllocator>
+struct Serializer<std::basic_string<Char, Traits, StringAllocator>> {
+	using String = std::basic_string<Char, Traits, StringAllocator>;
+
+	template <typename Writer>
+	static void Write(Writer& writer, const String& value) {
+		const uint64_t size = value.size();
+		writer.Write(&size, sizeof(size));
+		writer.Write(value.data(), value.size() * sizeof(Char));
+	}
+
+	template <typename Reader>
+	static String Read(Reader& reader) {
+		uint64_t size = 0;
+		reader.Read(&size, sizeof(size));
+		if (size > std::numeric_limits<size_t>::max() / sizeof(Char)) {
+			throw SerializationError("String too large");
+		}
+		String value(static_cast<size_t>(size), Char());
+		reader.Read(value.data(), value.size() * sizeof(Char));
+		return value;
+	}
+};
+
+// Вложенные векторы записываются количеством и элементами без отдельного заголовка
+template <typename T, typename Allocator, typename GrowthPolicy>
+struct Serializer<Vector<T, Allocator, GrowthPolicy>> {
+	template <typename Writer>
+	static void Write(Writer& writer, const Vector<T, Allocator, GrowthPolicy>& value) {
+		const uint64_t size = value.Size();
+		writer.Write(&size, sizeof(size));
+		serialization_detail::WriteElements(value.begin(), value.Size(), writer);
+	}
+
+	template <typename Reader>
+	static Vector<T, Allocator, GrowthPolicy> Read(Reader& reader) {
+		uint64_t size = 0;
+		reader.Read(&size, sizeof(size));
+		if (size > std::numeric_limits<size_t>::max()) {
+			throw SerializationError("Vector too large");
+		}
+		Vector<T, Allocator, GrowthPolicy> value;
+		serialization_detail::ReadElements(reader, static_cast<size_t>(size), value);
+		return value;
+	}
+};
+
+// Число байт, которые запишет Serialize
+template <typename T, typename Allocator, typename GrowthPolicy>
+size_t SerializedSize(const Vector<T, Allocator, GrowthPolicy>& vector) {
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		return sizeof(SerializationHeader) + vector.Size() * sizeof(T);
+	}
+	else {
+		serialization_detail::MeasuringWriter measure;
+		serialization_detail::WriteElements(vector.begin(), vector.Size(), measure);
+		return sizeof(SerializationHeader) + measure.Size();
+	}
+}
+
+// Записывает вектор в writer. Контрольная сумма хранится в заголовке, поэтому элементы обходятся дважды:
+// первый раз, чтобы посчитать размер данных и контрольную сумму, второй — для записи
+template <typename T, typename Allocator, typename GrowthPolicy, typename Writer>
+void Serialize(const Vector<T, Allocator, GrowthPolicy>& vector, Writer& writer) {
+	using namespace serialization_detail;
+	SerializationHeader header;
+	header.element_size = sizeof(T);
+	header.count = vector.Size();
+	MeasuringWriter measure;
+	WriteElements(vector.begin(), vector.Size(), measure);
+	header.payload_size = measure.Size();
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		header.flags = SerializationHeader::TRIVIAL_LAYOUT;
+	}
+	SealHeader(header, measure.GetChecksum());
+
+	if constexpr (std::is_trivially_copyable_v<T> && HasWriteGather<Writer>::value) {
+		const ConstBuffer buffers[] = { { &header, sizeof(header) }, { vector.begin(), header.payload_size } };
+		writer.WriteGather(buffers, std::size(buffers));
+	}
+	else {
+		writer.Write(&header, sizeof(header));
+		WriteElements(vector.begin(), vector.Size(), writer);
+	}
+}
+
+// Читает вектор, записанный Serialize, и заменяет им содержимое vector. Элементы тривиально копируемых
+// типов читаются одним вызовом прямо в буфер вектора. Данные нетривиальных типов сначала читаются целиком
+// и проверяются по контрольной сумме, а уже затем разбираются. Память выделяется только после проверки
+// контрольной суммы заголовка.
+// Если чтение или проверка завершились ошибкой, vector не меняется
+template <typename T, typename Allocator, typename GrowthPolicy, typename Reader>
+void Deserialize(Reader& reader, Vector<T, Allocator, GrowthPolicy>& vector) {
+	using namespace serialization_detail;
+	SerializationHeader header;
+	reader.Read(&header, sizeof(header));
+	CheckHeader<T>(header);
+	Vector<T, Allocator, GrowthPolicy> result(vector.GetAllocator());
+	if constexpr (std::is_trivially_copyable_v<T>) {
+		ReadElements(reader, static_cast<size_t>(header.count), result);
+		if (PayloadChecksum(header, result.begin()) != header.checksum) {
+			throw SerializationError("Checksum mismatch");
+		}
+	}
+	else {
+		Vector<char> payload;
+		payload.ResizeUninitialized(static_cast<size_t>(header.payload_size));
+		reader.Read(payload.begin(), payload.Size());
+		if (PayloadChecksum(header, payload.begin()) != header.checksum) {
+			throw SerializationError("Checksum mismatch");
+		}
+		BufferReader payload_reader(payload.begin(), payload.Size());
+		ReadElements(payload_reader, static_cast<size_t>(header.count), result);
+		if (payload_reader.Remaining() != 0) {
+			throw SerializationError("Trailing bytes in payload");
+		}
+	}
+	vector.Swap(result);
+}
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth, typename Reader>
+Vector<T, Allocator, GrowthPolicy> Deserialize(Reader& reader) {
+	Vector<T, Allocator, GrowthPolicy> result;
+	Deserialize(reader, result);
+	return result;
+}
+
+// Элементы сообщения, уже загруженного в память, без копирования: Span указывает прямо в буфер data,
+// который должен жить, пока используется результат. Данные должны быть выровнены для T.
+// Проверку контрольной суммы, требующую прохода по всем данным, можно отключить для доверенных буферов
+template <typename T>
+Span<const T> DeserializeView(const void* data, size_t size, bool verify_checksum = true) {
+	static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be viewed in place");
+	using namespace serialization_detail;
+	SerializationHeader header;
+	if (size < sizeof(header)) {
+		throw SerializationError("Unexpected end of buffer");
+	}
+	std::memcpy(&header, data, sizeof(header));
+	CheckHeader<T>(header);
+	if (header.payload_size > size - sizeof(header)) {
+		throw SerializationError("Unexpected end of buffer");
+	}
+	const char* payload = static_cast<const char*>(data) + sizeof(header);
+	if (reinterpret_cast<std::uintptr_t>(payload) % alignof(T) != 0) {
+		throw SerializationError("Payload is not aligned for the element type");
+	}
+	if (verify_checksum && PayloadChecksum(header, payload) != header.checksum) {
+		throw SerializationError("Checksum mismatch");
+	}
+	return Span<const T>(reinterpret_cast<const T*>(payload), static_cast<size_t>(header.count));
+}
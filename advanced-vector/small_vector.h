@@ -0,0 +1,248 @@
+#pragma once
+#include "vector.h"
+
+// Вектор, хранящий до N элементов внутри самого объекта. Память в куче выделяется через RawMemory
+// только тогда, когда элементы перестают помещаться во встроенный буфер.
+// Гарантии безопасности исключений такие же, как у Vector
+template <typename T, size_t N>
+class SmallVector {
+	static_assert(N > 0, "SmallVector needs a non-empty inline buffer");
+
+public:
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	iterator begin() noexcept {
+		return Data();
+	}
+	iterator end() noexcept {
+		return Data() + size_;
+	}
+	const_iterator begin() const noexcept {
+		return Data();
+	}
+	const_iterator end() const noexcept {
+		return Data() + size_;
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	SmallVector() = default;
+
+	explicit SmallVector(size_t size) {
+		Reserve(size);
+		std::uninitialized_value_construct_n(Data(), size);
+		size_ = size;
+	}
+
+	SmallVector(const SmallVector& other) {
+		Reserve(other.size_);
+		std::uninitialized_copy_n(other.Data(), other.size_, Data());
+		size_ = other.size_;
+	}
+
+	SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if (other.IsInline()) {
+			std::uninitialized_move_n(other.Data(), other.size_, Data());
+			std::destroy_n(other.Data(), other.size_);
+		}
+		else {
+			heap_.Swap(other.heap_);
+		}
+		size_ = std::exchange(other.size_, 0);
+	}
+
+	SmallVector& operator=(const SmallVector& rhs) {
+		if (this != &rhs) {
+			if (rhs.size_ > Capacity()) {
+				SmallVector rhs_copy(rhs);
+				*this = std::move(rhs_copy);
+			}
+			else if (rhs.size_ < size_) {
+				std::copy_n(rhs.Data(), rhs.size_, Data());
+				std::destroy_n(Data() + rhs.size_, size_ - rhs.size_);
+				size_ = rhs.size_;
+			}
+			else {
+				std::copy_n(rhs.Data(), size_, Data());
+				std::uninitialized_copy_n(rhs.Data() + size_, rhs.size_ - size_, Data() + size_);
+				size_ = rhs.size_;
+			}
+		}
+		return *this;
+	}
+
+	// Буфер в куче забирается целиком, а элементы из встроенного буфера rhs перемещаются поштучно
+	SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if (this != &rhs) {
+			std::destroy_n(Data(), size_);
+			size_ = 0;
+			if (rhs.IsInline()) {
+				std::uninitialized_move_n(rhs.Data(), rhs.size_, Data());
+				std::destroy_n(rhs.Data(), rhs.size_);
+			}
+			else {
+				heap_ = std::move(rhs.heap_);
+			}
+			size_ = std::exchange(rhs.size_, 0);
+		}
+		return *this;
+	}
+
+	void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if (!IsInline() && !other.IsInline()) {
+			heap_.Swap(other.heap_);
+			std::swap(size_, other.size_);
+			return;
+		}
+		SmallVector tmp(std::move(other));
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	void Reserve(size_t new_capacity) {
+		if (new_capacity <= Capacity()) {
+			return;
+		}
+		RawMemory<T> new_data(new_capacity);
+		RelocateN(Data(), size_, new_data.GetAddress());
+		heap_.Swap(new_data);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return IsInline() ? N : heap_.Capacity();
+	}
+
+	// Элементы хранятся во встроенном буфере, память в куче не выделена
+	bool IsInline() const noexcept {
+		return heap_.GetAddress() == nullptr;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<SmallVector&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return Data()[index];
+	}
+
+	void Resize(size_t new_size) {
+		if (new_size < size_) {
+			std::destroy_n(Data() + new_size, size_ - new_size);
+			size_ = new_size;
+		}
+		else if (new_size > size_) {
+			Reserve(new_size);
+			std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+			size_ = new_size;
+		}
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	void PopBack() noexcept {
+		std::destroy_at(Data() + size_ - 1);
+		--size_;
+	}
+
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		T* elem_pointer = nullptr;
+		if (size_ == Capacity()) {
+			RawMemory<T> new_data(size_ * 2);
+			// Новый элемент создаётся до переноса старых, так как аргументы могут ссылаться на элементы вектора
+			elem_pointer = new(new_data + size_) T(std::forward<Args>(args)...);
+			try {
+				RelocateN(Data(), size_, new_data.GetAddress());
+			}
+			catch (...) {
+				std::destroy_at(elem_pointer);
+				throw;
+			}
+			heap_.Swap(new_data);
+		}
+		else {
+			elem_pointer = new(Data() + size_) T(std::forward<Args>(args)...);
+		}
+		++size_;
+		return *elem_pointer;
+	}
+
+	template <typename... Args>
+	iterator Emplace(const_iterator pos, Args&&... args) {
+		const size_t index = pos - Data();
+		if (pos == end()) {
+			EmplaceBack(std::forward<Args>(args)...);
+		}
+		else if (size_ == Capacity()) {
+			RawMemory<T> new_data(size_ * 2);
+			T* elem_pointer = new(new_data + index) T(std::forward<Args>(args)...);
+			try {
+				RelocateWithGapN(Data(), size_, index, new_data.GetAddress());
+			}
+			catch (...) {
+				std::destroy_at(elem_pointer);
+				throw;
+			}
+			heap_.Swap(new_data);
+			++size_;
+		}
+		else if (AnyArgInRange(begin(), end(), args...)) {
+			// Сдвиг хвоста испортит аргументы, ссылающиеся на элементы вектора, поэтому элемент создаётся заранее
+			T value(std::forward<Args>(args)...);
+			return Emplace(begin() + index, std::move(value));
+		}
+		else {
+			EmplaceShifted(Data(), size_, index, std::forward<Args>(args)...);
+			++size_;
+		}
+		return begin() + index;
+	}
+
+	iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+		const size_t index = pos - Data();
+		std::move(begin() + index + 1, end(), begin() + index);
+		PopBack();
+		return begin() + index;
+	}
+
+	iterator Insert(const_iterator pos, const T& value) {
+		return Emplace(pos, value);
+	}
+
+	iterator Insert(const_iterator pos, T&& value) {
+		return Emplace(pos, std::move(value));
+	}
+
+	~SmallVector() {
+		std::destroy_n(Data(), size_);
+	}
+
+private:
+	T* Data() noexcept {
+		return IsInline() ? reinterpret_cast<T*>(inline_buffer_) : heap_.GetAddress();
+	}
+
+	const T* Data() const noexcept {
+		return const_cast<SmallVector&>(*this).Data();
+	}
+
+	RawMemory<T> heap_;
+	size_t size_ = 0;
+	alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+};
@@ -0,0 +1,410 @@
+#pragma once
+#include "vector.h"
+
+#include <iterator>
+#include <tuple>
+
+// Вектор строк из нескольких полей, в котором каждое поле (столбец) хранится в отдельном буфере RawMemory.
+// Цикл, читающий одно-два поля, загружает из памяти только их столбцы, а не строки целиком.
+// Буферы всех столбцов имеют одинаковую вместимость и растут вместе по правилам DoublingGrowth.
+// Гарантии безопасности исключений такие же, как у Vector: добавление и рост либо завершаются успешно,
+// либо оставляют вектор без изменений. Итератор строк выдаёт кортеж ссылок на поля строки
+template <typename... Ts>
+class SoAVector {
+	static_assert(sizeof...(Ts) != 0, "SoAVector needs at least one column");
+
+	template <bool IsConst>
+	class BasicIterator;
+
+public:
+	static constexpr size_t COLUMN_COUNT = sizeof...(Ts);
+
+	template <size_t I>
+	using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	// Строка — кортеж ссылок на элементы столбцов
+	using RowReference = std::tuple<Ts&...>;
+	using ConstRowReference = std::tuple<const Ts&...>;
+
+	using iterator = BasicIterator<false>;
+	using const_iterator = BasicIterator<true>;
+
+	iterator begin() noexcept {
+		return iterator(this, 0);
+	}
+	iterator end() noexcept {
+		return iterator(this, size_);
+	}
+	const_iterator begin() const noexcept {
+		return const_iterator(this, 0);
+	}
+	const_iterator end() const noexcept {
+		return const_iterator(this, size_);
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	SoAVector() = default;
+
+	explicit SoAVector(size_t size)
+		: columns_(RawMemory<Ts>(size)...) {
+		auto construct = [this, size](auto column) {
+			std::uninitialized_value_construct_n(Data<decltype(column)::value>(), size);
+		};
+		auto rollback = [this, size](auto column) noexcept {
+			std::destroy_n(Data<decltype(column)::value>(), size);
+		};
+		ForEachColumnOrRollback(construct, rollback);
+		size_ = size;
+	}
+
+	SoAVector(const SoAVector& other)
+		: columns_(RawMemory<Ts>(other.size_)...) {
+		auto construct = [this, &other](auto column) {
+			constexpr size_t I = decltype(column)::value;
+			std::uninitialized_copy_n(other.template Data<I>(), other.size_, Data<I>());
+		};
+		auto rollback = [this, &other](auto column) noexcept {
+			std::destroy_n(Data<decltype(column)::value>(), other.size_);
+		};
+		ForEachColumnOrRollback(construct, rollback);
+		size_ = other.size_;
+	}
+
+	SoAVector(SoAVector&& other) noexcept
+		: columns_(std::move(other.columns_))
+		, size_(std::exchange(other.size_, 0)) {
+	}
+
+	SoAVector& operator=(const SoAVector& rhs) {
+		if (this != &rhs) {
+			SoAVector rhs_copy(rhs);
+			Swap(rhs_copy);
+		}
+		return *this;
+	}
+
+	SoAVector& operator=(SoAVector&& rhs) noexcept {
+		if (this != &rhs) {
+			Clear();
+			Swap(rhs);
+		}
+		return *this;
+	}
+
+	void Swap(SoAVector& other) noexcept {
+		SwapColumns(other, std::index_sequence_for<Ts...>());
+		std::swap(size_, other.size_);
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return std::get<0>(columns_).Capacity();
+	}
+
+	// Начало столбца I
+	template <size_t I>
+	ColumnType<I>* Data() noexcept {
+		return std::get<I>(columns_).GetAddress();
+	}
+
+	template <size_t I>
+	const ColumnType<I>* Data() const noexcept {
+		return std::get<I>(columns_).GetAddress();
+	}
+
+	// Элементы столбца I. Непрерывный диапазон удобен для векторизуемых циклов и vector_algorithms.h
+	template <size_t I>
+	Span<ColumnType<I>> Column() noexcept {
+		return Span<ColumnType<I>>(Data<I>(), size_);
+	}
+
+	template <size_t I>
+	Span<const ColumnType<I>> Column() const noexcept {
+		return Span<const ColumnType<I>>(Data<I>(), size_);
+	}
+
+	RowReference operator[](size_t index) noexcept {
+		assert(index < size_);
+		return Row(index, std::index_sequence_for<Ts...>());
+	}
+
+	ConstRowReference operator[](size_t index) const noexcept {
+		assert(index < size_);
+		return const_cast<SoAVector&>(*this).Row(index, std::index_sequence_for<Ts...>());
+	}
+
+	// Выделяет буферы всех столбцов под new_capacity строк
+	void Reserve(size_t new_capacity) {
+		if (new_capacity <= Capacity()) {
+			return;
+		}
+		Columns new_columns{ RawMemory<Ts>(new_capacity)... };
+		RelocateColumns(new_columns);
+		columns_.swap(new_columns);
+	}
+
+	void Resize(size_t new_size) {
+		if (new_size < size_) {
+			DestroyRows(new_size, size_ - new_size);
+			size_ = new_size;
+		}
+		else if (new_size > size_) {
+			Reserve(new_size);
+			const size_t count = new_size - size_;
+			auto construct = [this, count](auto column) {
+				std::uninitialized_value_construct_n(Data<decltype(column)::value>() + size_, count);
+			};
+			auto rollback = [this, count](auto column) noexcept {
+				std::destroy_n(Data<decltype(column)::value>() + size_, count);
+			};
+			ForEachColumnOrRollback(construct, rollback);
+			size_ = new_size;
+		}
+	}
+
+	// Добавляет строку, создавая элемент каждого столбца из соответствующего аргумента.
+	// Аргументы могут ссылаться на элементы вектора: при росте строка создаётся в новых буферах до переноса
+	template <typename... Args>
+	RowReference EmplaceBack(Args&&... fields) {
+		static_assert(sizeof...(Args) == COLUMN_COUNT, "EmplaceBack takes one argument per column");
+		auto args = std::forward_as_tuple(std::forward<Args>(fields)...);
+		if (size_ == Capacity()) {
+			Columns new_columns{ RawMemory<Ts>(DoublingGrowth::NextCapacity(Capacity(), size_ + 1, ROW_SIZE))... };
+			ConstructRow(new_columns, args);
+			try {
+				RelocateColumns(new_columns);
+			}
+			catch (...) {
+				DestroyRow(new_columns, size_);
+				throw;
+			}
+			columns_.swap(new_columns);
+		}
+		else {
+			ConstructRow(columns_, args);
+		}
+		++size_;
+		return (*this)[size_ - 1];
+	}
+
+	void PopBack() noexcept {
+		assert(size_ != 0);
+		--size_;
+		DestroyRow(columns_, size_);
+	}
+
+	void Clear() noexcept {
+		DestroyRows(0, size_);
+		size_ = 0;
+	}
+
+	~SoAVector() {
+		DestroyRows(0, size_);
+	}
+
+private:
+	using Columns = std::tuple<RawMemory<Ts>...>;
+
+	// Суммарный размер полей строки, по которому политика роста выбирает вместимость
+	static constexpr size_t ROW_SIZE = (sizeof(Ts) + ...);
+
+	// Перенос элемента может выбросить исключение, и тогда столбец копируется, а исходные элементы сохраняются
+	template <size_t I>
+	static constexpr bool RELOCATION_MAY_THROW
+		= !IsTriviallyRelocatableV<ColumnType<I>> && !std::is_nothrow_move_constructible_v<ColumnType<I>>;
+
+	// Вызывает construct(column) для столбцов по порядку (column — std::integral_constant с номером столбца).
+	// Если вызов для столбца выбросит исключение, уже обработанные столбцы откатываются вызовами rollback
+	template <size_t I = 0, typename Construct, typename Rollback>
+	static void ForEachColumnOrRollback(Construct& construct, Rollback& rollback) {
+		if constexpr (I != COLUMN_COUNT) {
+			construct(std::integral_constant<size_t, I>());
+			try {
+				ForEachColumnOrRollback<I + 1>(construct, rollback);
+			}
+			catch (...) {
+				rollback(std::integral_constant<size_t, I>());
+				throw;
+			}
+		}
+	}
+
+	// Переносит строки во вновь выделенные буферы to. Сначала копируются столбцы, перенос которых может
+	// выбросить исключение: при ошибке копии уничтожаются, а исходные столбцы остаются нетронутыми.
+	// Остальные столбцы переносятся без исключений, после чего исходные элементы уничтожаются
+	void RelocateColumns(Columns& to) {
+		auto copy = [this, &to](auto column) {
+			constexpr size_t I = decltype(column)::value;
+			if constexpr (RELOCATION_MAY_THROW<I>) {
+				UninitializedMoveOrCopyN(Data<I>(), size_, std::get<I>(to).GetAddress());
+			}
+		};
+		auto rollback = [this, &to](auto column) noexcept {
+			constexpr size_t I = decltype(column)::value;
+			if constexpr (RELOCATION_MAY_THROW<I>) {
+				std::destroy_n(std::get<I>(to).GetAddress(), size_);
+			}
+		};
+		ForEachColumnOrRollback(copy, rollback);
+		FinishRelocation(to, std::index_sequence_for<Ts...>());
+	}
+
+	template <size_t... I>
+	void FinishRelocation(Columns& to, std::index_sequence<I...>) noexcept {
+		const auto finish = [this, &to](auto column) noexcept {
+			constexpr size_t J = decltype(column)::value;
+			if constexpr (RELOCATION_MAY_THROW<J>) {
+				std::destroy_n(Data<J>(), size_);
+			}
+			else {
+				RelocateN(Data<J>(), size_, std::get<J>(to).GetAddress());
+			}
+		};
+		(finish(std::integral_constant<size_t, I>()), ...);
+	}
+
+	// Создаёт строку с номером size_ в буферах columns из кортежа аргументов
+	template <typename ArgsTuple>
+	void ConstructRow(Columns& columns, ArgsTuple& args) {
+		auto construct = [this, &columns, &args](auto column) {
+			constexpr size_t I = decltype(column)::value;
+			new(std::get<I>(columns) + size_) ColumnType<I>(std::get<I>(std::move(args)));
+		};
+		auto rollback = [this, &columns](auto column) noexcept {
+			std::destroy_at(std::get<decltype(column)::value>(columns) + size_);
+		};
+		ForEachColumnOrRollback(construct, rollback);
+	}
+
+	static void DestroyRow(Columns& columns, size_t index) noexcept {
+		std::apply([index](RawMemory<Ts>&... memory) {
+			(std::destroy_at(memory + index), ...);
+		}, columns);
+	}
+
+	void DestroyRows(size_t first, size_t count) noexcept {
+		std::apply([first, count](RawMemory<Ts>&... memory) {
+			(std::destroy_n(memory + first, count), ...);
+		}, columns_);
+	}
+
+	template <size_t... I>
+	RowReference Row(size_t index, std::index_sequence<I...>) noexcept {
+		return RowReference(std::get<I>(columns_)[index]...);
+	}
+
+	template <size_t... I>
+	void SwapColumns(SoAVector& other, std::index_sequence<I...>) noexcept {
+		(std::get<I>(columns_).Swap(std::get<I>(other.columns_)), ...);
+	}
+
+	// Итератор по строкам. Разыменование возвращает кортеж ссылок, поэтому строки удобно разбирать
+	// структурными привязками: for (auto [x, y] : v)
+	template <bool IsConst>
+	class BasicIterator {
+		using Owner = std::conditional_t<IsConst, const SoAVector, SoAVector>;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::tuple<Ts...>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::conditional_t<IsConst, ConstRowReference, RowReference>;
+
+		BasicIterator() = default;
+
+		BasicIterator(Owner* owner, size_t index) noexcept
+			: owner_(owner)
+			, index_(index) {
+		}
+
+		// iterator неявно преобразуется в const_iterator
+		template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+		BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+			: owner_(other.owner_)
+			, index_(other.index_) {
+		}
+
+		reference operator*() const noexcept {
+			return (*owner_)[index_];
+		}
+		reference operator[](difference_type offset) const noexcept {
+			return *(*this + offset);
+		}
+
+		BasicIterator& operator++() noexcept {
+			++index_;
+			return *this;
+		}
+		BasicIterator operator++(int) noexcept {
+			BasicIterator old = *this;
+			++index_;
+			return old;
+		}
+		BasicIterator& operator--() noexcept {
+			--index_;
+			return *this;
+		}
+		BasicIterator operator--(int) noexcept {
+			BasicIterator old = *this;
+			--index_;
+			return old;
+		}
+		BasicIterator& operator+=(difference_type offset) noexcept {
+			index_ += offset;
+			return *this;
+		}
+		BasicIterator& operator-=(difference_type offset) noexcept {
+			index_ -= offset;
+			return *this;
+		}
+		friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+			return it += offset;
+		}
+		friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+			return it += offset;
+		}
+		friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+			return it -= offset;
+		}
+		friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+		}
+
+		friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ == rhs.index_;
+		}
+		friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ != rhs.index_;
+		}
+		friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ < rhs.index_;
+		}
+		friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return rhs < lhs;
+		}
+		friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return !(rhs < lhs);
+		}
+		friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return !(lhs < rhs);
+		}
+
+	private:
+		friend class BasicIterator<!IsConst>;
+
+		Owner* owner_ = nullptr;
+		size_t index_ = 0;
+	};
+
+	Columns columns_;
+	size_t size_ = 0;
+};
@@ -0,0 +1,375 @@
+#pragma once
+#include "vector.h"
+
+#include <climits>
+#include <iterator>
+
+// Размер блока по умолчанию: наибольшая степень двойки элементов, помещающаяся в 64 КиБ (но не меньше 1)
+template <typename T>
+inline constexpr size_t DEFAULT_CHUNK_SIZE = [] {
+	size_t size = 1;
+	while (size * 2 * sizeof(T) <= (size_t{64} << 10)) {
+		size *= 2;
+	}
+	return size;
+}();
+
+// Вектор, который растёт добавлением блоков по ChunkSize элементов вместо перевыделения всего буфера.
+// Добавление элемента никогда не переносит существующие элементы, поэтому ссылки и указатели на них
+// остаются действительными, а пиковый объём памяти превышает занятый не больше чем на один блок.
+// Таблица блоков, как корзины ConcurrentVector, состоит из сегментов, размер которых удваивается, и сама
+// никогда не перевыделяется, поэтому добавление элемента выполняется за O(1) и в худшем случае.
+// Итераторы сохраняются при добавлении, но, в отличие от ссылок на элементы, указывают на таблицу внутри
+// объекта и становятся недействительными при его перемещении или обмене.
+// Элементы непрерывны только внутри блока; непрерывный Vector можно получить через Flatten
+template <typename T, size_t ChunkSize = DEFAULT_CHUNK_SIZE<T>>
+class StableVector {
+	static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+	template <bool IsConst>
+	class BasicIterator;
+
+public:
+	static constexpr size_t CHUNK_SIZE = ChunkSize;
+
+	using iterator = BasicIterator<false>;
+	using const_iterator = BasicIterator<true>;
+
+	iterator begin() noexcept {
+		return iterator(segments_, 0);
+	}
+	iterator end() noexcept {
+		return iterator(segments_, size_);
+	}
+	const_iterator begin() const noexcept {
+		return const_iterator(segments_, 0);
+	}
+	const_iterator end() const noexcept {
+		return const_iterator(segments_, size_);
+	}
+	const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	const_iterator cend() const noexcept {
+		return end();
+	}
+
+	StableVector() = default;
+
+	explicit StableVector(size_t size)
+		: StableVector() {
+		Resize(size);
+	}
+
+	// Конструктор делегирует пустому, поэтому при исключении уже созданные элементы уничтожит деструктор
+	StableVector(const StableVector& other)
+		: StableVector() {
+		Reserve(other.size_);
+		for (const T& value : other) {
+			EmplaceBack(value);
+		}
+	}
+
+	StableVector(StableVector&& other) noexcept {
+		Swap(other);
+	}
+
+	StableVector& operator=(const StableVector& rhs) {
+		if (this != &rhs) {
+			StableVector rhs_copy(rhs);
+			Swap(rhs_copy);
+		}
+		return *this;
+	}
+
+	StableVector& operator=(StableVector&& rhs) noexcept {
+		if (this != &rhs) {
+			Clear();
+			Swap(rhs);
+		}
+		return *this;
+	}
+
+	void Swap(StableVector& other) noexcept {
+		for (size_t segment = 0; segment != SEGMENT_COUNT; ++segment) {
+			segments_[segment].Swap(other.segments_[segment]);
+		}
+		std::swap(chunk_count_, other.chunk_count_);
+		std::swap(size_, other.size_);
+	}
+
+	// Выделяет блоки под new_capacity элементов
+	void Reserve(size_t new_capacity) {
+		const size_t chunk_count = (new_capacity + ChunkSize - 1) / ChunkSize;
+		while (chunk_count_ < chunk_count) {
+			AddChunk();
+		}
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	size_t Capacity() const noexcept {
+		return chunk_count_ * ChunkSize;
+	}
+
+	const T& operator[](size_t index) const noexcept {
+		return const_cast<StableVector&>(*this)[index];
+	}
+
+	T& operator[](size_t index) noexcept {
+		assert(index < size_);
+		return *ElementAt(segments_, index);
+	}
+
+	void Resize(size_t new_size) {
+		while (size_ > new_size) {
+			PopBack();
+		}
+		Reserve(new_size);
+		while (size_ < new_size) {
+			EmplaceBack();
+		}
+	}
+
+	void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	// Выполняется за O(1) в худшем случае: выделяется не больше одного блока и одного сегмента таблицы,
+	// а существующие блоки и их описатели не переносятся.
+	// Аргументы могут ссылаться на элементы вектора, так как элементы не перемещаются
+	template <typename... Args>
+	T& EmplaceBack(Args&&... args) {
+		if (size_ == Capacity()) {
+			AddChunk();
+		}
+		T* elem_pointer = new(ElementAt(segments_, size_)) T(std::forward<Args>(args)...);
+		++size_;
+		return *elem_pointer;
+	}
+
+	void PopBack() noexcept {
+		assert(size_ != 0);
+		--size_;
+		std::destroy_at(ElementAt(segments_, size_));
+	}
+
+	// Уничтожает элементы, оставляя выделенные блоки
+	void Clear() noexcept {
+		ForEachChunk([](T* data, size_t count) {
+			std::destroy_n(data, count);
+		});
+		size_ = 0;
+	}
+
+	// Освобождает блоки, в которых не осталось элементов, и ставшие ненужными сегменты таблицы
+	void ShrinkToFit() noexcept {
+		const size_t chunk_count = (size_ + ChunkSize - 1) / ChunkSize;
+		while (chunk_count_ > chunk_count) {
+			--chunk_count_;
+			std::destroy_at(&ChunkAt(segments_, chunk_count_));
+		}
+		const size_t first_unused = chunk_count_ == 0 ? 0 : SegmentIndex(chunk_count_ - 1) + 1;
+		for (size_t segment = first_unused; segment != SEGMENT_COUNT; ++segment) {
+			segments_[segment] = Segment();
+		}
+	}
+
+	// Копирует элементы в непрерывный Vector
+	Vector<T> Flatten() const& {
+		Vector<T> result;
+		result.Reserve(size_);
+		ForEachChunk([&result](const T* data, size_t count) {
+			result.Append(data, data + count);
+		});
+		return result;
+	}
+
+	// Перемещает элементы в непрерывный Vector и освобождает блоки
+	Vector<T> Flatten() && {
+		Vector<T> result;
+		result.Reserve(size_);
+		ForEachChunk([&result](T* data, size_t count) {
+			result.Append(std::make_move_iterator(data), std::make_move_iterator(data + count));
+		});
+		Clear();
+		ShrinkToFit();
+		return result;
+	}
+
+	~StableVector() {
+		Clear();
+		ShrinkToFit();
+	}
+
+private:
+	using Chunk = RawMemory<T>;
+	// Сегмент таблицы: описатели блоков создаются в нём по одному по мере добавления блоков
+	using Segment = RawMemory<Chunk>;
+
+	static constexpr size_t FloorLog2(size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+		return sizeof(unsigned long long) * CHAR_BIT - 1 - __builtin_clzll(value);
+#else
+		size_t log = 0;
+		while (value >>= 1) {
+			++log;
+		}
+		return log;
+#endif
+	}
+
+	static constexpr size_t FIRST_SEGMENT_SIZE = 8;
+	static constexpr size_t FIRST_SEGMENT_LOG = FloorLog2(FIRST_SEGMENT_SIZE);
+	// Сегментов хватает, чтобы адресовать блоки для любого индекса size_t
+	static constexpr size_t SEGMENT_COUNT = sizeof(size_t) * CHAR_BIT - FloorLog2(ChunkSize) - FIRST_SEGMENT_LOG + 1;
+
+	// Сегмент s вмещает FIRST_SEGMENT_SIZE << s блоков
+	static size_t SegmentIndex(size_t chunk) noexcept {
+		return FloorLog2(chunk + FIRST_SEGMENT_SIZE) - FIRST_SEGMENT_LOG;
+	}
+
+	static Chunk& ChunkAt(Segment* segments, size_t chunk) noexcept {
+		const size_t segment = SegmentIndex(chunk);
+		return segments[segment][chunk + FIRST_SEGMENT_SIZE - (FIRST_SEGMENT_SIZE << segment)];
+	}
+
+	static T* ElementAt(Segment* segments, size_t index) noexcept {
+		return ChunkAt(segments, index / ChunkSize) + index % ChunkSize;
+	}
+
+	// Выделяет следующий блок, а при заполнении таблицы — ещё один сегмент. Существующие сегменты не меняются
+	void AddChunk() {
+		const size_t segment = SegmentIndex(chunk_count_);
+		if (segments_[segment].GetAddress() == nullptr) {
+			segments_[segment] = Segment(FIRST_SEGMENT_SIZE << segment);
+		}
+		new(&ChunkAt(segments_, chunk_count_)) Chunk(ChunkSize);
+		++chunk_count_;
+	}
+
+	// Вызывает function(data, count) для заполненной части каждого блока
+	template <typename Function>
+	void ForEachChunk(Function function) {
+		for (size_t first = 0; first < size_; first += ChunkSize) {
+			function(ElementAt(segments_, first), std::min(ChunkSize, size_ - first));
+		}
+	}
+
+	template <typename Function>
+	void ForEachChunk(Function function) const {
+		const_cast<StableVector&>(*this).ForEachChunk([&function](T* data, size_t count) {
+			function(static_cast<const T*>(data), count);
+		});
+	}
+
+	template <bool IsConst>
+	class BasicIterator {
+		using SegmentPointer = std::conditional_t<IsConst, const Segment*, Segment*>;
+
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<IsConst, const T*, T*>;
+		using reference = std::conditional_t<IsConst, const T&, T&>;
+
+		BasicIterator() = default;
+
+		BasicIterator(SegmentPointer segments, size_t index) noexcept
+			: segments_(segments)
+			, index_(index) {
+		}
+
+		// iterator неявно преобразуется в const_iterator
+		template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+		BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+			: segments_(other.segments_)
+			, index_(other.index_) {
+		}
+
+		reference operator*() const noexcept {
+			return *ElementAt(const_cast<Segment*>(segments_), index_);
+		}
+		pointer operator->() const noexcept {
+			return &**this;
+		}
+		reference operator[](difference_type offset) const noexcept {
+			return *(*this + offset);
+		}
+
+		BasicIterator& operator++() noexcept {
+			++index_;
+			return *this;
+		}
+		BasicIterator operator++(int) noexcept {
+			BasicIterator old = *this;
+			++index_;
+			return old;
+		}
+		BasicIterator& operator--() noexcept {
+			--index_;
+			return *this;
+		}
+		BasicIterator operator--(int) noexcept {
+			BasicIterator old = *this;
+			--index_;
+			return old;
+		}
+		BasicIterator& operator+=(difference_type offset) noexcept {
+			index_ += offset;
+			return *this;
+		}
+		BasicIterator& operator-=(difference_type offset) noexcept {
+			index_ -= offset;
+			return *this;
+		}
+		friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+			return it += offset;
+		}
+		friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+			return it += offset;
+		}
+		friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+			return it -= offset;
+		}
+		friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+		}
+
+		friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ == rhs.index_;
+		}
+		friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ != rhs.index_;
+		}
+		friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return lhs.index_ < rhs.index_;
+		}
+		friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return rhs < lhs;
+		}
+		friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return !(rhs < lhs);
+		}
+		friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+			return !(lhs < rhs);
+		}
+
+	private:
+		friend class BasicIterator<!IsConst>;
+
+		SegmentPointer segments_ = nullptr;
+		size_t index_ = 0;
+	};
+
+	Segment segments_[SEGMENT_COUNT];
+	size_t chunk_count_ = 0;
+	size_t size_ = 0;
+};
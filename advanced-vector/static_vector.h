@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace static_vector_detail {
+
+// Тривиально копируемые и присваиваемые элементы хранятся в обычном массиве: для литеральных типов все операции
+// StaticVector доступны в константных выражениях. Незанятые позиции массива содержат созданные
+// по умолчанию значения, поэтому добавление элемента — это присваивание. Типы с удалённым присваиванием
+// или константными членами, которые Vector хранит без ограничений, попадают в общий вариант
+template <typename T, size_t N, bool = std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+	&& std::is_trivially_copy_assignable_v<T> && std::is_trivially_move_assignable_v<T>>
+struct Storage {
+	constexpr T* Data() noexcept {
+		return elements;
+	}
+
+	constexpr const T* Data() const noexcept {
+		return elements;
+	}
+
+	template <typename... Args>
+	constexpr T& ConstructAt(size_t index, Args&&... args) {
+		elements[index] = T(std::forward<Args>(args)...);
+		return elements[index];
+	}
+
+	constexpr void DestroyAt(size_t /*index*/) noexcept {
+	}
+
+	T elements[N]{};
+	size_t size = 0;
+};
+
+// Остальные элементы создаются в выровненном буфере через placement new и уничтожаются явно
+template <typename T, size_t N>
+struct Storage<T, N, false> {
+	Storage() noexcept {
+	}
+
+	Storage(const Storage& other) {
+		std::uninitialized_copy_n(other.Data(), other.size, Data());
+		size = other.size;
+	}
+
+	Storage(Storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		std::uninitialized_move_n(other.Data(), other.size, Data());
+		size = other.size;
+		other.Clear();
+	}
+
+	Storage& operator=(const Storage& rhs) {
+		if (this != &rhs) {
+			Assign(rhs.Data(), rhs.size);
+		}
+		return *this;
+	}
+
+	Storage& operator=(Storage&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+		&& std::is_nothrow_move_constructible_v<T>) {
+		if (this != &rhs) {
+			Assign(std::make_move_iterator(rhs.Data()), rhs.size);
+			rhs.Clear();
+		}
+		return *this;
+	}
+
+	~Storage() {
+		Clear();
+	}
+
+	T* Data() noexcept {
+		return std::launder(reinterpret_cast<T*>(buffer));
+	}
+
+	const T* Data() const noexcept {
+		return std::launder(reinterpret_cast<const T*>(buffer));
+	}
+
+	template <typename... Args>
+	T& ConstructAt(size_t index, Args&&... args) {
+		return *new(Data() + index) T(std::forward<Args>(args)...);
+	}
+
+	void DestroyAt(size_t index) noexcept {
+		std::destroy_at(Data() + index);
+	}
+
+	void Clear() noexcept {
+		std::destroy_n(Data(), size);
+		size = 0;
+	}
+
+	// Общая часть переприсваивается, недостающие элементы создаются, лишние уничтожаются
+	template <typename InputIt>
+	void Assign(InputIt first, size_t count) {
+		const size_t common = std::min(size, count);
+		for (size_t i = 0; i != common; ++i, ++first) {
+			Data()[i] = *first;
+		}
+		for (; size < count; ++first) {
+			ConstructAt(size, *first);
+			++size;
+		}
+		std::destroy_n(Data() + count, size - count);
+		size = count;
+	}
+
+	alignas(T) unsigned char buffer[N * sizeof(T)];
+	size_t size = 0;
+};
+
+}  // namespace static_vector_detail
+
+// Вектор с вместимостью N, хранящий элементы внутри самого объекта и никогда не обращающийся к куче.
+// Функции-члены повторяют Vector, но вместо роста буфера при превышении вместимости выбрасывается
+// std::length_error, до изменения вектора. Для литеральных тривиально копируемых и присваиваемых типов
+// все операции constexpr, а сам StaticVector тривиально копируется
+template <typename T, size_t N>
+class StaticVector {
+	static_assert(N > 0, "StaticVector needs a non-empty buffer");
+
+public:
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	constexpr iterator begin() noexcept {
+		return storage_.Data();
+	}
+	constexpr iterator end() noexcept {
+		return storage_.Data() + storage_.size;
+	}
+	constexpr const_iterator begin() const noexcept {
+		return storage_.Data();
+	}
+	constexpr const_iterator end() const noexcept {
+		return storage_.Data() + storage_.size;
+	}
+	constexpr const_iterator cbegin() const noexcept {
+		return begin();
+	}
+	constexpr const_iterator cend() const noexcept {
+		return end();
+	}
+
+	constexpr StaticVector() = default;
+
+	constexpr explicit StaticVector(size_t size) {
+		Resize(size);
+	}
+
+	constexpr StaticVector(std::initializer_list<T> values) {
+		CheckCapacity(values.size());
+		for (const T& value : values) {
+			EmplaceBack(value);
+		}
+	}
+
+	constexpr void Swap(StaticVector& other) {
+		StaticVector tmp(std::move(other));
+		other = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	constexpr size_t Size() const noexcept {
+		return storage_.size;
+	}
+
+	static constexpr size_t Capacity() noexcept {
+		return N;
+	}
+
+	constexpr const T& operator[](size_t index) const noexcept {
+		assert(index < storage_.size);
+		return storage_.Data()[index];
+	}
+
+	constexpr T& operator[](size_t index) noexcept {
+		assert(index < storage_.size);
+		return storage_.Data()[index];
+	}
+
+	constexpr void Resize(size_t new_size) {
+		CheckCapacity(new_size);
+		while (storage_.size > new_size) {
+			PopBack();
+		}
+		for (; storage_.size < new_size; ++storage_.size) {
+			storage_.ConstructAt(storage_.size);
+		}
+	}
+
+	constexpr void Clear() noexcept {
+		while (storage_.size != 0) {
+			PopBack();
+		}
+	}
+
+	constexpr void PushBack(const T& value) {
+		EmplaceBack(value);
+	}
+
+	constexpr void PushBack(T&& value) {
+		EmplaceBack(std::move(value));
+	}
+
+	constexpr void PopBack() noexcept {
+		assert(storage_.size != 0);
+		storage_.DestroyAt(--storage_.size);
+	}
+
+	template <typename... Args>
+	constexpr T& EmplaceBack(Args&&... args) {
+		CheckCapacity(storage_.size + 1);
+		T& elem = storage_.ConstructAt(storage_.size, std::forward<Args>(args)...);
+		++storage_.size;
+		return elem;
+	}
+
+	// Новый элемент создаётся до сдвига хвоста, так как аргументы могут ссылаться на элементы вектора
+	template <typename... Args>
+	constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+		const size_t index = pos - begin();
+		if (index == storage_.size) {
+			EmplaceBack(std::forward<Args>(args)...);
+			return begin() + index;
+		}
+		CheckCapacity(storage_.size + 1);
+		T value(std::forward<Args>(args)...);
+		T* data = storage_.Data();
+		storage_.ConstructAt(storage_.size, std::move(data[storage_.size - 1]));
+		++storage_.size;
+		for (size_t i = storage_.size - 2; i != index; --i) {
+			data[i] = std::move(data[i - 1]);
+		}
+		data[index] = std::move(value);
+		return begin() + index;
+	}
+
+	constexpr iterator Insert(const_iterator pos, const T& value) {
+		return Emplace(pos, value);
+	}
+
+	constexpr iterator Insert(const_iterator pos, T&& value) {
+		return Emplace(pos, std::move(value));
+	}
+
+	constexpr iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+		return Erase(pos, pos + 1);
+	}
+
+	constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+		const size_t index = first - begin();
+		const size_t count = last - first;
+		T* data = storage_.Data();
+		for (size_t i = index; i + count < storage_.size; ++i) {
+			data[i] = std::move(data[i + count]);
+		}
+		for (size_t i = 0; i != count; ++i) {
+			PopBack();
+		}
+		return begin() + index;
+	}
+
+private:
+	static constexpr void CheckCapacity(size_t size) {
+		if (size > N) {
+			throw std::length_error("StaticVector capacity exceeded");
+		}
+	}
+
+	static_vector_detail::Storage<T, N> storage_;
+};
@@ -0,0 +1,544 @@
+// Случайные последовательности операций над Vector со сверкой со std::vector, внедрением отказов
+// при выделении памяти и создании элементов и контролем регрессий производительности.
+//   g++ -std=c++17 -O2 stress.cpp -o stress
+//   ./stress --seed=1 --ops=200000                 проверка корректности и замер
+//   ./stress --baseline=stress_baseline.txt --update-baseline   запись эталонных показателей
+//   ./stress --baseline=stress_baseline.txt        сравнение с эталоном, код возврата 1 при регрессии
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Исключение, которым StressObj имитирует отказ конструктора
+struct InjectedFailure : std::exception {
+    const char* what() const noexcept override {
+        return "Injected failure";
+    }
+};
+
+// Отказ наступает на countdown-м обращении после взведения; 0 — отказы выключены
+struct FailureCountdown {
+    bool Tick() noexcept {
+        return countdown > 0 && --countdown == 0;
+    }
+
+    long long countdown = 0;
+};
+
+// Аллокатор, через который RawMemory::Allocate выделяет буферы. Считает выделения и выбрасывает
+// std::bad_alloc по команде FAILURE
+template <typename T>
+struct FailingAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    FailingAllocator() = default;
+
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (failure.Tick()) {
+            throw std::bad_alloc();
+        }
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const FailingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const FailingAllocator<U>&) const noexcept {
+        return false;
+    }
+
+    static inline FailureCountdown failure;
+    static inline size_t allocations = 0;
+};
+
+// Элемент, создание и копирование которого может отказать. Перемещение не выбрасывает исключений, как
+// у большинства реальных типов, поэтому Vector переносит элементы перемещением. Счётчик живых объектов
+// позволяет заметить утечку или двойное уничтожение
+struct StressObj {
+    StressObj() {
+        Construct();
+    }
+
+    explicit StressObj(int value)
+        : value(value) {
+        Construct();
+    }
+
+    StressObj(const StressObj& other)
+        : value(other.value) {
+        Construct();
+    }
+
+    StressObj(StressObj&& other) noexcept
+        : value(other.value) {
+        ++alive;
+    }
+
+    StressObj& operator=(const StressObj& other) {
+        if (failure.Tick()) {
+            throw InjectedFailure();
+        }
+        value = other.value;
+        return *this;
+    }
+
+    StressObj& operator=(StressObj&& other) noexcept {
+        value = other.value;
+        return *this;
+    }
+
+    ~StressObj() {
+        --alive;
+    }
+
+    void Construct() {
+        if (failure.Tick()) {
+            throw InjectedFailure();
+        }
+        ++alive;
+    }
+
+    int value = 0;
+
+    static inline FailureCountdown failure;
+    static inline long long alive = 0;
+};
+
+using StressVector = Vector<StressObj, FailingAllocator<StressObj>>;
+
+enum class Op {
+    EMPLACE_BACK,
+    PUSH_BACK_COPY,
+    EMPLACE,
+    INSERT_COUNT,
+    APPEND,
+    ERASE,
+    ERASE_RANGE,
+    POP_BACK,
+    RESIZE,
+    RESERVE,
+    SHRINK_TO_FIT,
+    COPY_ASSIGN,
+    MOVE_ASSIGN,
+    CLEAR,
+    COUNT,
+};
+
+const char* OpName(Op op) {
+    static const char* const NAMES[] = {"EmplaceBack", "PushBack(copy)", "Emplace", "Insert(count)", "Append",
+        "Erase", "Erase(range)", "PopBack", "Resize", "Reserve", "ShrinkToFit", "operator=(copy)",
+        "operator=(move)", "Clear"};
+    return NAMES[static_cast<int>(op)];
+}
+
+struct Options {
+    uint64_t seed = 1;
+    size_t ops = 200'000;
+    // Доля операций, при которых взводится отказ
+    double failure_rate = 0.05;
+    // Допустимое ухудшение относительно эталона
+    double threshold = 0.3;
+    std::string baseline;
+    bool update_baseline = false;
+};
+
+struct RunResult {
+    size_t ops = 0;
+    size_t failures = 0;
+    size_t allocations = 0;
+    double ops_per_second = 0;
+};
+
+// Ошибка сверки: сообщение с номером операции позволяет воспроизвести её с тем же --seed
+class StressError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class StressRunner {
+public:
+    StressRunner(uint64_t seed, double failure_rate)
+        : random_(seed)
+        , failure_rate_(failure_rate) {
+    }
+
+    RunResult Run(size_t ops) {
+        RunResult result;
+        const size_t allocations = FailingAllocator<StressObj>::allocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i != ops; ++i) {
+            index_ = i;
+            if (Step()) {
+                ++result.failures;
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.ops = ops;
+        result.allocations = FailingAllocator<StressObj>::allocations - allocations;
+        result.ops_per_second = ops / std::max(elapsed.count(), 1e-9);
+        vector_.Clear();
+        Check(StressObj::alive == 0, "objects leaked after the run");
+        return result;
+    }
+
+private:
+    // Выполняет одну случайную операцию над вектором и эталоном. Возвращает true, если был внедрён отказ
+    bool Step() {
+        const Op op = static_cast<Op>(Uniform(0, static_cast<size_t>(Op::COUNT) - 1));
+        op_ = op;
+        const std::vector<int> before = oracle_;
+        // Операции, после отказа которых вектор обязан остаться прежним (строгая гарантия)
+        bool strong = op == Op::EMPLACE_BACK || op == Op::PUSH_BACK_COPY || op == Op::APPEND || op == Op::RESIZE
+            || op == Op::RESERVE || op == Op::SHRINK_TO_FIT;
+        if ((op == Op::EMPLACE || op == Op::INSERT_COUNT) && vector_.Size() == vector_.Capacity()) {
+            // При реаллокации новые элементы создаются в новом буфере до переноса старых
+            strong = true;
+        }
+        bool failed = false;
+        try {
+            Apply(op);
+        }
+        catch (const InjectedFailure&) {
+            failed = true;
+        }
+        catch (const std::bad_alloc&) {
+            failed = true;
+        }
+        Disarm();
+        const std::vector<int> actual = Contents();
+        if (failed) {
+            if (strong) {
+                Check(actual == before, "strong exception guarantee violated");
+            }
+            // После отказа операции с базовой гарантией эталоном становится фактическое содержимое
+            oracle_ = actual;
+        }
+        Check(vector_.Size() <= vector_.Capacity(), "size exceeds capacity");
+        Check(StressObj::alive == static_cast<long long>(vector_.Size()), "alive object count mismatch");
+        Check(actual == oracle_, "contents differ from std::vector");
+        return failed;
+    }
+
+    void Apply(Op op) {
+        const size_t size = vector_.Size();
+        switch (op) {
+        case Op::EMPLACE_BACK: {
+            const int value = Value();
+            Arm();
+            vector_.EmplaceBack(value);
+            oracle_.push_back(value);
+            break;
+        }
+        case Op::PUSH_BACK_COPY: {
+            // Копия собственного элемента проверяет добавление по ссылке на элемент того же вектора
+            if (size == 0) {
+                break;
+            }
+            const size_t index = Uniform(0, size - 1);
+            Arm();
+            vector_.PushBack(vector_[index]);
+            oracle_.push_back(oracle_[index]);
+            break;
+        }
+        case Op::EMPLACE: {
+            const size_t index = Uniform(0, size);
+            const int value = Value();
+            Arm();
+            vector_.Emplace(vector_.begin() + index, value);
+            oracle_.insert(oracle_.begin() + index, value);
+            break;
+        }
+        case Op::INSERT_COUNT: {
+            const size_t index = Uniform(0, size);
+            const size_t count = Uniform(0, 8);
+            const StressObj value(Value());
+            Arm();
+            vector_.Insert(vector_.begin() + index, count, value);
+            oracle_.insert(oracle_.begin() + index, count, value.value);
+            break;
+        }
+        case Op::APPEND: {
+            const std::vector<StressObj> values = Values(Uniform(0, 16));
+            Arm();
+            vector_.Append(values.begin(), values.end());
+            for (const StressObj& value : values) {
+                oracle_.push_back(value.value);
+            }
+            break;
+        }
+        case Op::ERASE: {
+            if (size == 0) {
+                break;
+            }
+            const size_t index = Uniform(0, size - 1);
+            vector_.Erase(vector_.begin() + index);
+            oracle_.erase(oracle_.begin() + index);
+            break;
+        }
+        case Op::ERASE_RANGE: {
+            const size_t first = Uniform(0, size);
+            const size_t last = Uniform(first, std::min(size, first + 16));
+            vector_.Erase(vector_.begin() + first, vector_.begin() + last);
+            oracle_.erase(oracle_.begin() + first, oracle_.begin() + last);
+            break;
+        }
+        case Op::POP_BACK:
+            if (size != 0) {
+                vector_.PopBack();
+                oracle_.pop_back();
+            }
+            break;
+        case Op::RESIZE: {
+            // Размер держится около MAX_SIZE / 2, чтобы векторы не росли неограниченно
+            const size_t new_size = Uniform(0, std::min(MAX_SIZE, size + 32));
+            Arm();
+            vector_.Resize(new_size);
+            oracle_.resize(new_size);
+            break;
+        }
+        case Op::RESERVE: {
+            const size_t new_capacity = Uniform(0, size * 2 + 16);
+            Arm();
+            vector_.Reserve(new_capacity);
+            break;
+        }
+        case Op::SHRINK_TO_FIT:
+            Arm();
+            vector_.ShrinkToFit();
+            break;
+        case Op::COPY_ASSIGN: {
+            const StressVector source = MakeVector(Uniform(0, std::min(MAX_SIZE, size * 2 + 8)));
+            Arm();
+            vector_ = source;
+            oracle_ = ContentsOf(source);
+            break;
+        }
+        case Op::MOVE_ASSIGN: {
+            StressVector source = MakeVector(Uniform(0, std::min(MAX_SIZE, size * 2 + 8)));
+            const std::vector<int> values = ContentsOf(source);
+            vector_ = std::move(source);
+            Check(source.Size() == 0, "moved-from vector is not empty");
+            oracle_ = values;
+            break;
+        }
+        case Op::CLEAR:
+            if (Uniform(0, 15) == 0) {
+                vector_.Clear();
+                oracle_.clear();
+            }
+            break;
+        case Op::COUNT:
+            break;
+        }
+        if (vector_.Size() > MAX_SIZE) {
+            vector_.Resize(MAX_SIZE / 2);
+            oracle_.resize(MAX_SIZE / 2);
+        }
+    }
+
+    // С вероятностью failure_rate взводит отказ одного из ближайших выделений памяти или созданий элемента
+    void Arm() {
+        if (failure_rate_ <= 0 || std::uniform_real_distribution<double>(0, 1)(random_) >= failure_rate_) {
+            return;
+        }
+        const long long countdown = static_cast<long long>(Uniform(1, 8));
+        if (Uniform(0, 1) == 0) {
+            FailingAllocator<StressObj>::failure.countdown = countdown;
+        }
+        else {
+            StressObj::failure.countdown = countdown;
+        }
+    }
+
+    static void Disarm() noexcept {
+        FailingAllocator<StressObj>::failure.countdown = 0;
+        StressObj::failure.countdown = 0;
+    }
+
+    size_t Uniform(size_t min, size_t max) {
+        return std::uniform_int_distribution<size_t>(min, max)(random_);
+    }
+
+    int Value() {
+        return static_cast<int>(Uniform(0, 1'000'000));
+    }
+
+    std::vector<StressObj> Values(size_t count) {
+        std::vector<StressObj> values;
+        values.reserve(count);
+        for (size_t i = 0; i != count; ++i) {
+            values.emplace_back(Value());
+        }
+        return values;
+    }
+
+    StressVector MakeVector(size_t count) {
+        StressVector result;
+        result.Reserve(count);
+        for (size_t i = 0; i != count; ++i) {
+            result.EmplaceBack(Value());
+        }
+        return result;
+    }
+
+    static std::vector<int> ContentsOf(const StressVector& vector) {
+        std::vector<int> values;
+        values.reserve(vector.Size());
+        for (const StressObj& value : vector) {
+            values.push_back(value.value);
+        }
+        return values;
+    }
+
+    std::vector<int> Contents() const {
+        return ContentsOf(vector_);
+    }
+
+    void Check(bool condition, const char* message) const {
+        if (!condition) {
+            throw StressError(std::string(message) + " after operation #" + std::to_string(index_) + " ("
+                + OpName(op_) + ")");
+        }
+    }
+
+    static constexpr size_t MAX_SIZE = 4096;
+
+    std::mt19937_64 random_;
+    double failure_rate_;
+    StressVector vector_;
+    std::vector<int> oracle_;
+    size_t index_ = 0;
+    Op op_ = Op::COUNT;
+};
+
+Options ParseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i != argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&arg](const char* prefix) -> const char* {
+            const size_t length = std::char_traits<char>::length(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--seed=")) {
+            options.seed = std::stoull(v);
+        }
+        else if (const char* v = value("--ops=")) {
+            options.ops = std::stoull(v);
+        }
+        else if (const char* v = value("--failure-rate=")) {
+            options.failure_rate = std::stod(v);
+        }
+        else if (const char* v = value("--threshold=")) {
+            options.threshold = std::stod(v);
+        }
+        else if (const char* v = value("--baseline=")) {
+            options.baseline = v;
+        }
+        else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        }
+        else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    return options;
+}
+
+// Эталон хранится строками "ключ значение"
+bool ReadBaseline(const std::string& path, RunResult& baseline) {
+    std::ifstream input(path);
+    if (!input) {
+        return false;
+    }
+    std::string key;
+    double value = 0;
+    while (input >> key >> value) {
+        if (key == "ops_per_second") {
+            baseline.ops_per_second = value;
+        }
+        else if (key == "allocations") {
+            baseline.allocations = static_cast<size_t>(value);
+        }
+    }
+    return true;
+}
+
+void WriteBaseline(const std::string& path, const RunResult& result) {
+    std::ofstream output(path);
+    output << "ops_per_second " << result.ops_per_second << '\n' << "allocations " << result.allocations << '\n';
+    if (!output) {
+        throw std::runtime_error("Cannot write baseline " + path);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options options = ParseOptions(argc, argv);
+
+        // Проверка корректности с отказами
+        StressRunner checked(options.seed, options.failure_rate);
+        const RunResult stress = checked.Run(options.ops);
+        std::cout << "stress: seed " << options.seed << ", " << stress.ops << " operations, " << stress.failures
+                  << " injected failures, all checks passed" << std::endl;
+
+        // Замер без отказов: при том же seed последовательность операций и число выделений детерминированы
+        StressRunner measured(options.seed, 0);
+        const RunResult performance = measured.Run(options.ops);
+        std::cout << "performance: " << static_cast<size_t>(performance.ops_per_second) << " ops/s, "
+                  << performance.allocations << " allocations" << std::endl;
+
+        if (options.baseline.empty()) {
+            return 0;
+        }
+        if (options.update_baseline) {
+            WriteBaseline(options.baseline, performance);
+            std::cout << "baseline written to " << options.baseline << std::endl;
+            return 0;
+        }
+        RunResult baseline;
+        if (!ReadBaseline(options.baseline, baseline)) {
+            throw std::runtime_error("Cannot read baseline " + options.baseline);
+        }
+        bool regressed = false;
+        if (performance.ops_per_second < baseline.ops_per_second * (1 - options.threshold)) {
+            std::cerr << "throughput regression: " << static_cast<size_t>(performance.ops_per_second) << " ops/s, baseline "
+                      << static_cast<size_t>(baseline.ops_per_second) << std::endl;
+            regressed = true;
+        }
+        if (performance.allocations > baseline.allocations * (1 + options.threshold)) {
+            std::cerr << "allocation regression: " << performance.allocations << " allocations, baseline "
+                      << baseline.allocations << std::endl;
+            regressed = true;
+        }
+        return regressed ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
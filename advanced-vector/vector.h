@@ -1,40 +1,320 @@
 #pragma once
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
 
+#include "vector_stats.h"
+
+// Признак того, что объект типа T можно перенести в другую область памяти побайтовым копированием,
+// не вызывая конструктор перемещения и деструктор исходного объекта.
+// Для собственных типов пользователь может специализировать этот шаблон
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+// std::unique_ptr с деструктором по умолчанию хранит лишь указатель и не ссылается сам на себя
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Конструирует в неинициализированной памяти to копии n элементов из from, перемещая их,
+// если это не нарушит строгую гарантию безопасности исключений
+template <typename T>
+void UninitializedMoveOrCopyN(T* from, size_t n, T* to) {
+	if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+		std::uninitialized_move_n(from, n, to);
+	}
+	else {
+		std::uninitialized_copy_n(from, n, to);
+	}
+}
+
+// Переносит n элементов из from в неинициализированную память to и уничтожает исходные.
+// Если перенос прервался исключением, исходные элементы остаются нетронутыми
+template <typename T>
+void RelocateN(T* from, size_t n, T* to) {
+	if constexpr (IsTriviallyRelocatableV<T>) {
+		if (n != 0) {
+			std::memcpy(static_cast<void*>(to), from, n * sizeof(T));
+		}
+	}
+	else {
+		UninitializedMoveOrCopyN(from, n, to);
+		std::destroy_n(from, n);
+	}
+}
+
+// Переносит n элементов из from в неинициализированную память to, оставляя gap_size свободных ячеек
+// начиная с to[gap_index] для вставляемых элементов. Если перенос прервался исключением,
+// исходные элементы остаются нетронутыми
+template <typename T>
+void RelocateWithGapN(T* from, size_t n, size_t gap_index, T* to, size_t gap_size = 1) {
+	if constexpr (IsTriviallyRelocatableV<T>) {
+		if (n != 0) {
+			std::memcpy(static_cast<void*>(to), from, gap_index * sizeof(T));
+			std::memcpy(static_cast<void*>(to + gap_index + gap_size), from + gap_index, (n - gap_index) * sizeof(T));
+		}
+	}
+	else {
+		UninitializedMoveOrCopyN(from, gap_index, to);
+		try {
+			UninitializedMoveOrCopyN(from + gap_index, n - gap_index, to + gap_index + gap_size);
+		}
+		catch (...) {
+			std::destroy_n(to, gap_index);
+			throw;
+		}
+		std::destroy_n(from, n);
+	}
+}
+
+// Конструирует элемент из args на позиции index массива first из size элементов, сдвигая хвост на одну ячейку.
+// За последним элементом должна быть свободная ячейка, а аргументы не должны ссылаться на элементы массива.
+// Если конструирование прервалось исключением, хвост возвращается на место
+template <typename T, typename... Args>
+T* EmplaceShifted(T* first, size_t size, size_t index, Args&&... args) {
+	T* pos = first + index;
+	if constexpr (IsTriviallyRelocatableV<T>) {
+		std::memmove(static_cast<void*>(pos + 1), pos, (size - index) * sizeof(T));
+		try {
+			return new(pos) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			std::memmove(static_cast<void*>(pos), pos + 1, (size - index) * sizeof(T));
+			throw;
+		}
+	}
+	else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+		new(first + size) T(std::move(first[size - 1]));
+		std::move_backward(pos, first + size - 1, first + size);
+		std::destroy_at(pos);
+		try {
+			return new(pos) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			new(pos) T(std::move(pos[1]));
+			std::move(pos + 2, first + size + 1, pos + 1);
+			std::destroy_at(first + size);
+			throw;
+		}
+	}
+	else {
+		// Откатить сдвиг без риска нового исключения нельзя, поэтому значение создаётся до сдвига
+		T value(std::forward<Args>(args)...);
+		new(first + size) T(std::move(first[size - 1]));
+		std::move_backward(pos, first + size - 1, first + size);
+		*pos = std::move(value);
+		return pos;
+	}
+}
+
+// Проверяет, расположен ли хотя бы один из объектов args в памяти [first, last)
+template <typename T, typename... Args>
+bool AnyArgInRange(const T* first, const T* last, const Args&... args) noexcept {
+	const std::less<const void*> less;
+	return ((!less(std::addressof(args), first) && less(std::addressof(args), last)) || ...);
+}
+
+template <typename It>
+inline constexpr bool IsForwardIteratorV
+	= std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
+// Отсекает перегрузки, принимающие диапазон, когда вместо итераторов переданы, например, количество и значение
+template <typename It>
+using RequireInputIterator = std::enable_if_t<
+	std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// Однонаправленный итератор, выдающий одно и то же значение. Позволяет вставлять count копий значения
+// теми же алгоритмами, что и диапазоны
+template <typename T>
+class RepeatIterator {
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const T*;
+	using reference = const T&;
+
+	RepeatIterator() = default;
+
+	RepeatIterator(const T& value, size_t index) noexcept
+		: value_(&value)
+		, index_(index) {
+	}
+
+	reference operator*() const noexcept {
+		return *value_;
+	}
+
+	pointer operator->() const noexcept {
+		return value_;
+	}
+
+	RepeatIterator& operator++() noexcept {
+		++index_;
+		return *this;
+	}
+
+	RepeatIterator operator++(int) noexcept {
+		RepeatIterator old = *this;
+		++index_;
+		return old;
+	}
+
+	bool operator==(const RepeatIterator& other) const noexcept {
+		return index_ == other.index_;
+	}
+
+	bool operator!=(const RepeatIterator& other) const noexcept {
+		return index_ != other.index_;
+	}
+
+private:
+	const T* value_ = nullptr;
+	size_t index_ = 0;
+};
+
+// Непрерывный диапазон элементов, которыми Span не владеет (аналог std::span из C++20)
 template <typename T>
-class RawMemory {
+class Span {
 public:
+	using iterator = T*;
+
+	Span() = default;
+
+	Span(T* data, size_t size) noexcept
+		: data_(data)
+		, size_(size) {
+	}
+
+	// Span<T> неявно преобразуется в Span<const T>
+	template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+	Span(const Span<U>& other) noexcept
+		: data_(other.Data())
+		, size_(other.Size()) {
+	}
+
+	iterator begin() const noexcept {
+		return data_;
+	}
+	iterator end() const noexcept {
+		return data_ + size_;
+	}
+
+	T* Data() const noexcept {
+		return data_;
+	}
+
+	size_t Size() const noexcept {
+		return size_;
+	}
+
+	T& operator[](size_t index) const noexcept {
+		assert(index < size_);
+		return data_[index];
+	}
+
+	// Часть диапазона из count элементов, начиная с offset
+	Span Subspan(size_t offset, size_t count) const noexcept {
+		assert(offset <= size_ && count <= size_ - offset);
+		return Span(data_ + offset, count);
+	}
+
+private:
+	T* data_ = nullptr;
+	size_t size_ = 0;
+};
+
+// Аллокатор может сообщить, сколько элементов на самом деле поместилось в выделенный блок, если предоставляет
+// метод allocate_at_least(n), возвращающий структуру с полями ptr и count (как в C++23)
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {
+};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator, std::void_t<decltype(std::declval<Allocator&>().allocate_at_least(size_t{}))>>
+	: std::true_type {
+};
+
+// Аллокатор может расширять блоки на месте, если предоставляет метод reallocate(p, old_n, new_n)
+// с семантикой realloc: содержимое блока переносится побайтово, а результат содержит поля ptr и count
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+	std::declval<typename std::allocator_traits<Allocator>::pointer>(), size_t{}, size_t{}))>>
+	: std::true_type {
+};
+
+// Выравнивание, которое аллокатор гарантирует для каждого буфера. Аллокатор может объявить его
+// в статическом члене ALIGNMENT, иначе гарантируется лишь выравнивание, необходимое для T
+template <typename Allocator, typename = void>
+struct AllocatorAlignment : std::integral_constant<size_t, alignof(typename Allocator::value_type)> {
+};
+
+template <typename Allocator>
+struct AllocatorAlignment<Allocator, std::void_t<decltype(Allocator::ALIGNMENT)>>
+	: std::integral_constant<size_t, Allocator::ALIGNMENT> {
+};
+
+// Владеет сырой памятью под capacity элементов типа T, выделенной при помощи аллокатора Allocator.
+// Аллокатор хранится вместе с буфером и перемещается и обменивается вместе с ним,
+// так как освободить память может только тот аллокатор, который её выделил
+template <typename T, typename Allocator = std::allocator<T>>
+class RawMemory : private Allocator {
+	using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+	using allocator_type = Allocator;
+
+	// Буфер можно увеличить через Reallocate, не выделяя новый блок рядом со старым
+	static constexpr bool CAN_REALLOCATE = HasReallocate<Allocator>::value;
+
 	RawMemory() = default;
 
-	explicit RawMemory(size_t capacity)
-		: buffer_(Allocate(capacity))
-		, capacity_(capacity) {
+	explicit RawMemory(const Allocator& alloc) noexcept
+		: Allocator(alloc) {
+	}
+
+	// Если аллокатор выделил больше памяти, чем запрошено, излишек становится частью вместимости
+	explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+		: Allocator(alloc) {
+		Allocate(capacity);
 	}
 
 	~RawMemory() {
-		Deallocate(buffer_);
+		Deallocate(buffer_, capacity_);
 	}
 
 	RawMemory(const RawMemory&) = delete;
 	RawMemory& operator=(const RawMemory& rhs) = delete;
-	RawMemory(RawMemory&& other) noexcept : buffer_(std::move(other.buffer_)), capacity_(std::move(other.capacity_)) {
-		other.buffer_ = nullptr;
-		other.capacity_ = 0;
+	RawMemory(RawMemory&& other) noexcept
+		: Allocator(std::move(other.GetAllocatorRef()))
+		, buffer_(std::exchange(other.buffer_, nullptr))
+		, capacity_(std::exchange(other.capacity_, 0)) {
 	}
 	RawMemory& operator=(RawMemory&& rhs) noexcept {
 		if (this == &rhs) {
 			return *this;
 		}
-		~RawMemory();
-		buffer_ = std::move(rhs.buffer_);
-		capacity_ = std::move(rhs.capacity_);
-		rhs.buffer_ = nullptr;
-		rhs.capacity_ = 0;
+		Deallocate(buffer_, capacity_);
+		GetAllocatorRef() = std::move(rhs.GetAllocatorRef());
+		buffer_ = std::exchange(rhs.buffer_, nullptr);
+		capacity_ = std::exchange(rhs.capacity_, 0);
+		return *this;
 	}
 
 	T* operator+(size_t offset) noexcept {
@@ -57,8 +337,10 @@ public:
 	}
 
 	void Swap(RawMemory& other) noexcept {
-		std::swap(buffer_, other.buffer_);
-		std::swap(capacity_, other.capacity_);
+		using std::swap;
+		swap(GetAllocatorRef(), other.GetAllocatorRef());
+		swap(buffer_, other.buffer_);
+		swap(capacity_, other.capacity_);
 	}
 
 	const T* GetAddress() const noexcept {
@@ -73,24 +355,143 @@ public:
 		return capacity_;
 	}
 
+	Allocator GetAllocator() const noexcept {
+		return GetAllocatorRef();
+	}
+
+	// Изменяет размер буфера до new_capacity элементов (или больше, если так решит аллокатор).
+	// Содержимое буфера переносится побайтово, поэтому метод применим только к побайтово переносимым T.
+	// При исключении буфер остаётся прежним
+	void Reallocate(size_t new_capacity) {
+		static_assert(CAN_REALLOCATE, "Allocator does not support reallocate");
+		static_assert(IsTriviallyRelocatableV<T>, "Reallocate moves elements bytewise");
+		if (buffer_ == nullptr) {
+			Allocate(new_capacity);
+			return;
+		}
+		auto result = GetAllocatorRef().reallocate(buffer_, capacity_, new_capacity);
+		buffer_ = result.ptr;
+		capacity_ = result.count;
+	}
+
 private:
-	// Выделяет сырую память под n элементов и возвращает указатель на неё
-	static T* Allocate(size_t n) {
-		return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+	Allocator& GetAllocatorRef() noexcept {
+		return *this;
+	}
+
+	const Allocator& GetAllocatorRef() const noexcept {
+		return *this;
+	}
+
+	// Выделяет сырую память хотя бы под n элементов и запоминает её в buffer_ и capacity_
+	void Allocate(size_t n) {
+		if (n == 0) {
+			return;
+		}
+		if constexpr (HasAllocateAtLeast<Allocator>::value) {
+			auto result = GetAllocatorRef().allocate_at_least(n);
+			buffer_ = result.ptr;
+			capacity_ = result.count;
+		}
+		else {
+			buffer_ = AllocTraits::allocate(GetAllocatorRef(), n);
+			capacity_ = n;
+		}
 	}
 
-	// Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-	static void Deallocate(T* buf) noexcept {
-		operator delete(buf);
+	// Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+	void Deallocate(T* buf, size_t n) noexcept {
+		if (buf != nullptr) {
+			AllocTraits::deallocate(GetAllocatorRef(), buf, n);
+		}
 	}
 
 	T* buffer_ = nullptr;
 	size_t capacity_ = 0;
 };
 
-template <typename T>
+// Метка конструктора, создающего элементы инициализацией по умолчанию, а не инициализацией значением.
+// Для тривиальных типов это означает, что память не обнуляется
+struct DefaultInitTag {
+	explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag DEFAULT_INIT{};
+
+// Размер строки кэша, с шагом которого ForEachChunk запрашивает предвыборку следующей части
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+// По умолчанию ForEachChunk передаёт части из 4 КиБ: этого достаточно, чтобы предвыборка следующей части
+// успела завершиться, пока обрабатывается текущая, и обе части помещаются в кэш L1
+inline constexpr size_t FOR_EACH_CHUNK_BYTES = 4096;
+
+// Политики роста определяют, какую вместимость выбрать, когда в буфере вектора закончилось место.
+// NextCapacity получает текущую вместимость, требуемое число элементов и размер элемента в байтах
+// и возвращает новую вместимость не меньше требуемой
+
+// Удваивает вместимость
+struct DoublingGrowth {
+	static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+		return std::max(required, capacity == 0 ? size_t{1} : capacity * 2);
+	}
+};
+
+// Увеличивает вместимость в полтора раза. Расходует меньше памяти, чем удвоение, и позволяет аллокатору
+// повторно использовать освобождённые при предыдущих ростах блоки
+struct OneAndHalfGrowth {
+	static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+		return std::max(required, capacity < 2 ? capacity + 1 : capacity + capacity / 2);
+	}
+};
+
+// Увеличивает вместимость в полтора раза и округляет размер буфера вверх до размерного класса аллокатора:
+// четыре класса на каждую степень двойки, как в jemalloc и tcmalloc. Память, которую аллокатор
+// всё равно выделил бы сверх запрошенной, становится вместимостью
+struct SizeClassGrowth {
+	static size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+		const size_t bytes = RoundToSizeClass(OneAndHalfGrowth::NextCapacity(capacity, required, element_size) * element_size);
+		return std::max(required, bytes / element_size);
+	}
+
+	static size_t RoundToSizeClass(size_t bytes) noexcept {
+		const size_t MIN_CLASS = 16;
+		if (bytes <= MIN_CLASS) {
+			return MIN_CLASS;
+		}
+		size_t power = MIN_CLASS;
+		while (power * 2 < bytes) {
+			power *= 2;
+		}
+		const size_t step = power / 4;
+		return (bytes + step - 1) / step * step;
+	}
+};
+
+// Удваивает вместимость, а буферы от 2 МиБ округляет до целого числа огромных страниц,
+// чтобы хвост последней страницы не пропадал зря
+struct HugePageGrowth {
+	static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+	static size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+		const size_t new_capacity = DoublingGrowth::NextCapacity(capacity, required, element_size);
+		const size_t bytes = new_capacity * element_size;
+		if (bytes < HUGE_PAGE_SIZE) {
+			return new_capacity;
+		}
+		return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE / element_size;
+	}
+};
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
 class Vector {
+	using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+	using allocator_type = Allocator;
+
+	// Выравнивание начала буфера, которое гарантирует аллокатор
+	static constexpr size_t BUFFER_ALIGNMENT = AllocatorAlignment<Allocator>::value;
+
 	using iterator = T*;
 	using const_iterator = const T*;
 
@@ -115,15 +516,33 @@ public:
 
 	Vector() = default;
 
-	explicit Vector(size_t size)
-		: data_(size)
+	explicit Vector(const Allocator& alloc) noexcept
+		: data_(alloc) {
+	}
+
+	explicit Vector(size_t size, const Allocator& alloc = Allocator())
+		: data_(size, alloc)
 		, size_(size) {
+		RecordAllocation();
 		std::uninitialized_value_construct_n(data_.GetAddress(), size);
 	}
 
+	// Элементы создаются инициализацией по умолчанию, поэтому буфер тривиальных типов не заполняется нулями
+	Vector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+		: data_(size, alloc)
+		, size_(size) {
+		RecordAllocation();
+		std::uninitialized_default_construct_n(data_.GetAddress(), size);
+	}
+
 	Vector(const Vector& other)
-		: data_(other.size_)
+		: Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+	}
+
+	Vector(const Vector& other, const Allocator& alloc)
+		: data_(other.size_, alloc)
 		, size_(other.size_) {
+		RecordAllocation();
 		std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
 	}
 
@@ -133,70 +552,212 @@ public:
 		other.size_ = 0;
 	};
 
+	// Забирает буфер other, если он выделен равным аллокатором, иначе перемещает элементы поштучно
+	Vector(Vector&& other, const Allocator& alloc)
+		: data_(alloc) {
+		if (alloc == other.data_.GetAllocator()) {
+			SwapData(other);
+		}
+		else {
+			RawMemory<T, Allocator> new_data(other.size_, alloc);
+			std::uninitialized_move_n(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+			data_.Swap(new_data);
+			size_ = other.size_;
+			RecordAllocation();
+		}
+	}
+
 	Vector& operator=(const Vector& rhs) {
 		if (this != &rhs) {
-			if (rhs.size_ > data_.Capacity()) {
-				Vector rhs_copy(rhs);
-				Swap(rhs_copy);
+			if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+				&& !AllocTraits::is_always_equal::value) {
+				if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+					// Свои элементы надо освободить своим аллокатором до того, как он будет заменён аллокатором rhs
+					Vector rhs_copy(rhs, rhs.data_.GetAllocator());
+					SwapData(rhs_copy);
+					MergeStats(rhs_copy);
+					return *this;
+				}
 			}
-			else {
-				if (rhs.size_ < size_) {
-					for (size_t i = 0; i != rhs.size_; ++i) {
-						data_[i] = rhs.data_[i];
-					}
-					std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
-					size_ = rhs.size_;
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				// Элементы не требуют ни конструкторов, ни деструкторов, поэтому копируются одним блоком
+				// в свой буфер, который заменяется новым, только если его не хватает
+				if (rhs.size_ > data_.Capacity()) {
+					RawMemory<T, Allocator> new_data(rhs.size_, data_.GetAllocator());
+					data_.Swap(new_data);
+					RecordAllocation();
 				}
-				else {
-					for (size_t i = 0; i != size_; ++i) {
-						data_[i] = rhs.data_[i];
-					}
-					std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
-					size_ = rhs.size_;
+				if (rhs.size_ != 0) {
+					std::memcpy(static_cast<void*>(data_.GetAddress()), rhs.data_.GetAddress(), rhs.size_ * sizeof(T));
 				}
+				size_ = rhs.size_;
+			}
+			else {
+				// Существующие элементы переприсваиваются через copy_n, недостающие создаются копированием
+				AssignN(rhs.data_.GetAddress(), rhs.size_);
 			}
 		}
 		return *this;
 	};
-	Vector& operator=(Vector&& rhs) noexcept {
+	Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+		|| AllocTraits::is_always_equal::value) {
 		if (this != &rhs) {
-			if (rhs.size_ > data_.Capacity()) {
-				Vector rhs_copy(std::move(rhs));
-				Swap(rhs_copy);
-			}
-			else {
-				if (rhs.size_ < size_) {
-					Swap(rhs);
-					std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
-				}
-				else {
-					Swap(rhs);
+			if constexpr (!AllocTraits::propagate_on_container_move_assignment::value
+				&& !AllocTraits::is_always_equal::value) {
+				if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+					// Буфер чужого аллокатора забрать нельзя, поэтому элементы перемещаются в память своего
+					Vector rhs_moved(std::move(rhs), data_.GetAllocator());
+					SwapData(rhs_moved);
+					MergeStats(rhs_moved);
+					return *this;
 				}
 			}
+			// Буфер rhs забирается целиком, а прежние элементы уничтожаются вместе с временным вектором
+			Vector rhs_moved(std::move(rhs));
+			SwapData(rhs_moved);
 		}
 		return *this;
 	};
 
+	// Аллокаторы обмениваются, только если этого требует propagate_on_container_swap,
+	// в противном случае они должны быть равны
 	void Swap(Vector& other) noexcept {
-		data_.Swap(other.data_);
-		std::swap(size_, other.size_);
+		if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+			assert(data_.GetAllocator() == other.data_.GetAllocator());
+		}
+		SwapData(other);
 	};
 
 	void Reserve(size_t new_capacity) {
 		if (new_capacity <= data_.Capacity()) {
 			return;
 		}
-		RawMemory<T> new_data(new_capacity);
-		if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-			std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+		if constexpr (CAN_REALLOCATE) {
+			// Аллокатор может расширить блок на месте, избежав одновременного хранения двух буферов
+			ReallocateData(new_capacity);
+			return;
 		}
-		else {
-			std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+		RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+		RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+		data_.Swap(new_data);
+		RecordGrowth(size_);
+	}
+
+	// Уменьшает вместимость до размера вектора, перенося элементы так же, как Reserve
+	void ShrinkToFit() {
+		if (data_.Capacity() == size_) {
+			return;
 		}
-		std::destroy_n(data_.GetAddress(), size_);
+		if (size_ == 0) {
+			// Буфер только освобождается, выделения памяти не происходит
+			RawMemory<T, Allocator>(data_.GetAllocator()).Swap(data_);
+			return;
+		}
+		if constexpr (CAN_REALLOCATE) {
+			ReallocateData(size_);
+			return;
+		}
+		RawMemory<T, Allocator> new_data(size_, data_.GetAllocator());
+		RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
 		data_.Swap(new_data);
+		RecordGrowth(size_);
+	}
+
+	// Уничтожает все элементы, сохраняя вместимость
+	void Clear() noexcept {
+		std::destroy_n(data_.GetAddress(), size_);
+		size_ = 0;
+	}
+
+	// Передаёт буфер вместе с аллокатором и количеством созданных в нём элементов вызывающему коду.
+	// Вектор остаётся пустым и без памяти. Переданный буфер можно отдать другому вектору через Adopt
+	std::pair<RawMemory<T, Allocator>, size_t> Release() noexcept {
+		RawMemory<T, Allocator> released(data_.GetAllocator());
+		released.Swap(data_);
+		return { std::move(released), std::exchange(size_, 0) };
+	}
+
+	// Забирает буфер memory вместе с его аллокатором. Первые size элементов буфера должны быть созданы.
+	// Текущие элементы вектора уничтожаются, а его память освобождается
+	void Adopt(RawMemory<T, Allocator>&& memory, size_t size) noexcept {
+		assert(size <= memory.Capacity());
+		Clear();
+		data_ = std::move(memory);
+		size_ = size;
+	}
+
+	Allocator GetAllocator() const noexcept {
+		return data_.GetAllocator();
 	}
 
+	// Возвращает начало буфера, сообщая компилятору, что оно выровнено по границе Alignment байт.
+	// Это позволяет векторизовать циклы по элементам выровненными загрузками.
+	// По умолчанию используется выравнивание, гарантированное аллокатором
+	template <size_t Alignment = BUFFER_ALIGNMENT>
+	T* AssumeAligned() noexcept {
+		T* data = data_.GetAddress();
+		assert(reinterpret_cast<std::uintptr_t>(data) % Alignment == 0);
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<T*>(__builtin_assume_aligned(data, Alignment));
+#else
+		return data;
+#endif
+	}
+
+	template <size_t Alignment = BUFFER_ALIGNMENT>
+	const T* AssumeAligned() const noexcept {
+		return const_cast<Vector&>(*this).template AssumeAligned<Alignment>();
+	}
+
+	// Указатель на первый элемент (nullptr, если буфер не выделен)
+	T* Data() noexcept {
+		return data_.GetAddress();
+	}
+
+	const T* Data() const noexcept {
+		return data_.GetAddress();
+	}
+
+	// Элементы вектора как Span. Функция названа AsSpan, так как имя Span занято шаблоном класса
+	Span<T> AsSpan() noexcept {
+		return Span<T>(data_.GetAddress(), size_);
+	}
+
+	Span<const T> AsSpan() const noexcept {
+		return Span<const T>(data_.GetAddress(), size_);
+	}
+
+	// Доступ по индексу без проверки даже в сборках с assert: для горячих циклов, где индекс заведомо
+	// меньше Size()
+	T& UncheckedAt(size_t index) noexcept {
+		return data_.GetAddress()[index];
+	}
+
+	const T& UncheckedAt(size_t index) const noexcept {
+		return data_.GetAddress()[index];
+	}
+
+	// Передаёт функции function(Span<T>) элементы вектора по порядку частями по chunk_size элементов
+	// (последняя часть может быть короче). Перед обработкой части запрашивается предвыборка в кэш всей
+	// следующей части, поэтому память читается равномерным потоком без проверок индексов на каждом элементе
+	template <typename Function>
+	void ForEachChunk(Function function, size_t chunk_size = DefaultChunkSize()) {
+		ForEachChunkImpl(AsSpan(), function, chunk_size);
+	}
+
+	template <typename Function>
+	void ForEachChunk(Function function, size_t chunk_size = DefaultChunkSize()) const {
+		ForEachChunkImpl(AsSpan(), function, chunk_size);
+	}
+
+#ifdef VECTOR_ENABLE_STATS
+	// Статистика выделений памяти и роста этого вектора. Сводная статистика всех векторов
+	// доступна через VectorStatsRegistry::Global()
+	const VectorStats& GetStats() const noexcept {
+		return stats_;
+	}
+#endif
+
 	size_t Size() const noexcept {
 		return size_;
 	}
@@ -226,6 +787,66 @@ public:
 		}
 	};
 
+	// Как Resize, но новые элементы создаются инициализацией по умолчанию
+	void ResizeDefaultInit(size_t new_size) {
+		if (new_size < size_) {
+			std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+			size_ = new_size;
+		}
+		else if (new_size > size_) {
+			Reserve(new_size);
+			std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+			size_ = new_size;
+		}
+	}
+
+	// Меняет размер вектора тривиального типа, не трогая память новых элементов. Их значения не определены,
+	// пока не будут записаны, например, вызовом read() прямо в буфер вектора
+	void ResizeUninitialized(size_t new_size) {
+		static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+			"ResizeUninitialized requires a trivial element type");
+		Reserve(new_size);
+		size_ = new_size;
+	}
+
+	// Свободная часть буфера после последнего элемента, не короче min_count элементов. Если места не хватает,
+	// буфер растёт по политике роста, поэтому при заполнении небольшими порциями перенос элементов
+	// происходит логарифмическое число раз. Записанные сюда элементы (например, декодером прямо из сетевого
+	// буфера) становятся частью вектора после вызова CommitAppend
+	Span<T> SpareCapacity(size_t min_count) {
+		static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+			"SpareCapacity requires a trivial element type");
+		if (min_count > Capacity() - size_) {
+			Reserve(NextCapacity(size_ + min_count));
+		}
+		return Span<T>(data_.GetAddress() + size_, Capacity() - size_);
+	}
+
+	// Добавляет в вектор count элементов, записанных в начало SpareCapacity()
+	void CommitAppend(size_t count) noexcept {
+		assert(count <= Capacity() - size_);
+		size_ += count;
+	}
+
+	// Заполняет вектор из источника данных, пока тот не вернёт 0. Источник source(Span<T>) записывает
+	// элементы в начало переданной свободной части буфера (не короче batch_size элементов) и возвращает,
+	// сколько элементов записал, например сколько байт прочитал read() из сокета. Возвращает количество
+	// добавленных элементов. Если источник выбросит исключение, элементы предыдущих порций остаются в векторе
+	template <typename Source>
+	size_t AppendFrom(Source&& source, size_t batch_size = DefaultChunkSize()) {
+		assert(batch_size > 0);
+		const size_t old_size = size_;
+		while (true) {
+			const Span<T> spare = SpareCapacity(batch_size);
+			const size_t count = source(spare);
+			if (count == 0) {
+				break;
+			}
+			CommitAppend(count);
+		}
+		return size_ - old_size;
+	}
+
 	void PushBack(const T& value) {
 		EmplaceBack(value);
 	};
@@ -243,20 +864,33 @@ public:
 	T& EmplaceBack(Args&&... args) {
 		T* elem_pointer = nullptr;
 		if (size_ == Capacity()) {
-			Vector new_vector;
-			new_vector.Reserve(size_ == 0 ? 1 : size_ * 2);
-			new_vector.size_ = size_;
-			elem_pointer = new(new_vector.data_ + size_) T(T(std::forward<Args>(args)...));
-			if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-				std::uninitialized_move_n(data_.GetAddress(), size_, new_vector.data_.GetAddress());
+			if constexpr (CAN_REALLOCATE) {
+				// Realloc освобождает старый блок, поэтому аргументы, ссылающиеся на элементы вектора,
+				// сначала превращаются во временный объект
+				if (AnyArgInRange(data_.GetAddress(), data_ + size_, args...)) {
+					T value(std::forward<Args>(args)...);
+					return EmplaceBack(std::move(value));
+				}
+				Reserve(NextCapacity());
+				elem_pointer = new(data_ + size_) T(std::forward<Args>(args)...);
 			}
 			else {
-				std::uninitialized_copy_n(data_.GetAddress(), size_, new_vector.data_.GetAddress());
+				RawMemory<T, Allocator> new_data(NextCapacity(), data_.GetAllocator());
+				// Новый элемент создаётся до переноса старых, так как аргументы могут ссылаться на элементы вектора
+				elem_pointer = new(new_data + size_) T(std::forward<Args>(args)...);
+				try {
+					RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+				}
+				catch (...) {
+					std::destroy_at(elem_pointer);
+					throw;
+				}
+				data_.Swap(new_data);
+				RecordGrowth(size_);
 			}
-			Swap(new_vector);
 		}
 		else {
-			elem_pointer = new(data_ + size_) T(T(std::forward<Args>(args)...));
+			elem_pointer = new(data_ + size_) T(std::forward<Args>(args)...);
 		}
 		++size_;
 		return *elem_pointer;
@@ -264,48 +898,118 @@ public:
 
 	template <typename... Args>
 	iterator Emplace(const_iterator pos, Args&&... args) {
-		T* elem_pointer = nullptr;
-		size_t index = pos - data_.GetAddress();
+		const size_t index = pos - data_.GetAddress();
 		if (pos == end()) {
 			EmplaceBack(std::forward<Args>(args)...);
 		}
+		else if (size_ == Capacity() && !CAN_REALLOCATE) {
+			RawMemory<T, Allocator> new_data(NextCapacity(), data_.GetAllocator());
+			// Элемент создаётся сразу на своём месте в новом буфере, пока старые элементы ещё не перенесены
+			T* elem_pointer = new(new_data + index) T(std::forward<Args>(args)...);
+			try {
+				RelocateWithGapN(begin(), size_, index, new_data.GetAddress());
+			}
+			catch (...) {
+				std::destroy_at(elem_pointer);
+				throw;
+			}
+			data_.Swap(new_data);
+			RecordGrowth(size_);
+			++size_;
+		}
+		else if (AnyArgInRange(begin(), end(), args...)) {
+			// Сдвиг хвоста испортит аргументы, ссылающиеся на элементы вектора, поэтому элемент создаётся заранее
+			T value(std::forward<Args>(args)...);
+			return Emplace(begin() + index, std::move(value));
+		}
 		else {
 			if (size_ == Capacity()) {
-				Vector new_vector;
-				new_vector.Reserve(size_ == 0 ? 1 : size_ * 2);
-				new_vector.size_ = size_;
-				elem_pointer = new(new_vector.begin() + index) T(T(std::forward<Args>(args)...));
-				if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-					std::uninitialized_move_n(begin(), index, new_vector.begin());
-					std::uninitialized_move_n(begin() + index, size_ - index, new_vector.begin() + index + 1);
-				}
-				else {
-					std::uninitialized_copy_n(begin(), index, new_vector.begin());
-					std::uninitialized_copy_n(begin() + index, size_ - index, new_vector.begin() + index + 1);
-				}
-				Swap(new_vector);
-			}
-			else {
-				elem_pointer = new T(T(std::forward<Args>(args)...));
-				new(end()) T(std::move(*(end() - 1)));
-				//std::destroy_n(end() - 1, 1);
-				std::move_backward(begin() + index, end() - 1 , end());
-				std::move(elem_pointer, elem_pointer + 1, begin() + index);
-				std::destroy_n(elem_pointer, 1);
-				//delete elem_pointer;
+				Reserve(NextCapacity());
 			}
+			EmplaceShifted(begin(), size_, index, std::forward<Args>(args)...);
 			++size_;
 		}
 		return begin() + index;
 	}
 
-	iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
-		size_t index = pos - data_.GetAddress();
-		std::move(begin() + index + 1, end(), begin() + index);
-		PopBack();
+	iterator Erase(const_iterator pos) noexcept(IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+		const size_t index = pos - data_.GetAddress();
+		assert(index < size_);
+		if constexpr (IsTriviallyRelocatableV<T>) {
+			std::destroy_at(begin() + index);
+			std::memmove(static_cast<void*>(begin() + index), begin() + index + 1, (size_ - index - 1) * sizeof(T));
+			--size_;
+		}
+		else {
+			std::move(begin() + index + 1, end(), begin() + index);
+			PopBack();
+		}
 		return begin() + index;
 	};
 
+	// Удаляет элементы [first, last), сдвигая хвост один раз
+	iterator Erase(const_iterator first, const_iterator last) noexcept(
+		IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+		const size_t index = first - data_.GetAddress();
+		const size_t count = last - first;
+		assert(index + count <= size_);
+		T* pos = begin() + index;
+		if (count == 0) {
+			return pos;
+		}
+		if constexpr (IsTriviallyRelocatableV<T>) {
+			std::destroy_n(pos, count);
+			std::memmove(static_cast<void*>(pos), pos + count, (size_ - index - count) * sizeof(T));
+		}
+		else {
+			std::move(pos + count, end(), pos);
+			std::destroy_n(end() - count, count);
+		}
+		size_ -= count;
+		return pos;
+	}
+
+	// Удаляет все элементы, для которых pred вернул true, за один проход и возвращает их количество.
+	// Побайтово переносимые элементы сдвигаются блоками через memmove
+	template <typename Predicate>
+	size_t EraseIf(Predicate pred) {
+		const size_t old_size = size_;
+		if (old_size == 0) {
+			return 0;
+		}
+		if constexpr (IsTriviallyRelocatableV<T>) {
+			// [begin(), write) — оставленные элементы, [write, run) — пустые ячейки,
+			// [run, read) — оставленные элементы, ещё не сдвинутые на место
+			T* write = begin();
+			T* run = begin();
+			T* read = begin();
+			T* last = end();
+			try {
+				for (; read != last; ++read) {
+					if (pred(*read)) {
+						std::memmove(static_cast<void*>(write), run, (read - run) * sizeof(T));
+						write += read - run;
+						std::destroy_at(read);
+						run = read + 1;
+					}
+				}
+			}
+			catch (...) {
+				std::memmove(static_cast<void*>(write), run, (last - run) * sizeof(T));
+				size_ = (write - begin()) + (last - run);
+				throw;
+			}
+			std::memmove(static_cast<void*>(write), run, (last - run) * sizeof(T));
+			size_ = (write - begin()) + (last - run);
+		}
+		else {
+			T* new_end = std::remove_if(begin(), end(), std::ref(pred));
+			std::destroy_n(new_end, end() - new_end);
+			size_ = new_end - begin();
+		}
+		return old_size - size_;
+	}
+
 	iterator Insert(const_iterator pos, const T& value) {
 		return Emplace(pos, value);
 	};
@@ -314,11 +1018,352 @@ public:
 		return Emplace(pos, std::move(value));
 	};
 
+	// Вставляет count копий value перед pos, сдвигая хвост один раз
+	iterator Insert(const_iterator pos, size_t count, const T& value) {
+		const size_t index = pos - data_.GetAddress();
+		if (AnyArgInRange(begin(), end(), value)) {
+			const T value_copy(value);
+			InsertN(index, RepeatIterator<T>(value_copy, 0), count);
+		}
+		else {
+			InsertN(index, RepeatIterator<T>(value, 0), count);
+		}
+		return begin() + index;
+	}
+
+	// Вставляет копии элементов [first, last) перед pos. Как и в std::vector, диапазон не должен
+	// ссылаться на элементы самого вектора. Для однонаправленных итераторов память выделяется один раз,
+	// а хвост сдвигается один раз
+	template <typename InputIt, typename = RequireInputIterator<InputIt>>
+	iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+		const size_t index = pos - data_.GetAddress();
+		if constexpr (IsForwardIteratorV<InputIt>) {
+			InsertN(index, first, static_cast<size_t>(std::distance(first, last)));
+		}
+		else {
+			const size_t old_size = size_;
+			Append(first, last);
+			std::rotate(begin() + index, begin() + old_size, end());
+		}
+		return begin() + index;
+	}
+
+	// Добавляет в конец count копий value
+	void Append(size_t count, const T& value) {
+		if (AnyArgInRange(begin(), end(), value)) {
+			const T value_copy(value);
+			AppendN(RepeatIterator<T>(value_copy, 0), count);
+		}
+		else {
+			AppendN(RepeatIterator<T>(value, 0), count);
+		}
+	}
+
+	// Добавляет в конец копии элементов [first, last). Диапазон не должен ссылаться на элементы вектора
+	template <typename InputIt, typename = RequireInputIterator<InputIt>>
+	void Append(InputIt first, InputIt last) {
+		if constexpr (IsForwardIteratorV<InputIt>) {
+			AppendN(first, static_cast<size_t>(std::distance(first, last)));
+		}
+		else {
+			for (; first != last; ++first) {
+				EmplaceBack(*first);
+			}
+		}
+	}
+
+	// Заменяет содержимое вектора count копиями value
+	void Assign(size_t count, const T& value) {
+		if (AnyArgInRange(begin(), end(), value)) {
+			const T value_copy(value);
+			AssignN(RepeatIterator<T>(value_copy, 0), count);
+		}
+		else {
+			AssignN(RepeatIterator<T>(value, 0), count);
+		}
+	}
+
+	// Заменяет содержимое вектора копиями элементов [first, last), переиспользуя уже созданные элементы.
+	// Диапазон не должен ссылаться на элементы вектора
+	template <typename InputIt, typename = RequireInputIterator<InputIt>>
+	void Assign(InputIt first, InputIt last) {
+		if constexpr (IsForwardIteratorV<InputIt>) {
+			AssignN(first, static_cast<size_t>(std::distance(first, last)));
+		}
+		else {
+			size_t assigned = 0;
+			for (; first != last && assigned != size_; ++first, ++assigned) {
+				data_[assigned] = *first;
+			}
+			if (assigned != size_) {
+				Resize(assigned);
+			}
+			for (; first != last; ++first) {
+				EmplaceBack(*first);
+			}
+		}
+	}
+
 	~Vector() {
 		std::destroy_n(data_.GetAddress(), size_);
 	}
 
 private:
-	RawMemory<T> data_;
+	// Буфер растёт через realloc аллокатора, а не через выделение нового блока и перенос элементов
+	static constexpr bool CAN_REALLOCATE = RawMemory<T, Allocator>::CAN_REALLOCATE && IsTriviallyRelocatableV<T>;
+
+	// Изменяет вместимость через realloc аллокатора, отличая в статистике рост на месте от переезда буфера
+	void ReallocateData(size_t new_capacity) {
+		[[maybe_unused]] const std::uintptr_t old_address = reinterpret_cast<std::uintptr_t>(data_.GetAddress());
+		[[maybe_unused]] const size_t old_capacity = data_.Capacity();
+		data_.Reallocate(new_capacity);
+		RecordReallocation(old_address, old_capacity);
+	}
+
+#ifdef VECTOR_ENABLE_STATS
+	// Учитывает выделение текущего буфера вектора
+	void RecordAllocation() noexcept {
+		VectorStats delta;
+		if (data_.Capacity() != 0) {
+			delta.allocations = 1;
+			delta.bytes_allocated = data_.Capacity() * sizeof(T);
+		}
+		delta.peak_capacity = data_.Capacity();
+		Record(delta);
+	}
+
+	// Учитывает переезд relocated элементов в только что выделенный текущий буфер вектора
+	void RecordGrowth(size_t relocated) noexcept {
+		VectorStats delta;
+		delta.allocations = 1;
+		delta.bytes_allocated = data_.Capacity() * sizeof(T);
+		delta.reallocations = relocated != 0 ? 1 : 0;
+		if constexpr (IsTriviallyRelocatableV<T>) {
+			delta.elements_relocated = relocated;
+		}
+		else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+			delta.elements_moved = relocated;
+		}
+		else {
+			delta.elements_copied = relocated;
+		}
+		delta.peak_capacity = data_.Capacity();
+		Record(delta);
+	}
+
+	// Учитывает realloc буфера, который до вызова начинался с old_address и вмещал old_capacity элементов
+	void RecordReallocation(std::uintptr_t old_address, size_t old_capacity) noexcept {
+		if (old_address == 0 || reinterpret_cast<std::uintptr_t>(data_.GetAddress()) != old_address) {
+			RecordGrowth(size_);
+			return;
+		}
+		VectorStats delta;
+		delta.in_place_reallocations = 1;
+		if (data_.Capacity() > old_capacity) {
+			delta.bytes_allocated = (data_.Capacity() - old_capacity) * sizeof(T);
+		}
+		delta.peak_capacity = data_.Capacity();
+		Record(delta);
+	}
+
+	void Record(const VectorStats& delta) noexcept {
+		AddLocalStats(delta);
+		VectorStatsRegistry::Global().Add(delta);
+	}
+
+	// Переносит в статистику этого вектора выделения временного вектора, чей буфер он забрал через SwapData.
+	// В сводной статистике они уже учтены
+	void MergeStats(const Vector& other) noexcept {
+		AddLocalStats(other.stats_);
+	}
+
+	void AddLocalStats(const VectorStats& delta) noexcept {
+		stats_.allocations += delta.allocations;
+		stats_.bytes_allocated += delta.bytes_allocated;
+		stats_.reallocations += delta.reallocations;
+		stats_.in_place_reallocations += delta.in_place_reallocations;
+		stats_.elements_moved += delta.elements_moved;
+		stats_.elements_copied += delta.elements_copied;
+		stats_.elements_relocated += delta.elements_relocated;
+		stats_.peak_capacity = std::max(stats_.peak_capacity, delta.peak_capacity);
+	}
+#else
+	void RecordAllocation() noexcept {
+	}
+
+	void RecordGrowth(size_t /*relocated*/) noexcept {
+	}
+
+	void RecordReallocation(std::uintptr_t /*old_address*/, size_t /*old_capacity*/) noexcept {
+	}
+
+	void MergeStats(const Vector& /*other*/) noexcept {
+	}
+#endif
+
+	// Вместимость, до которой вырастет заполненный буфер при добавлении элемента
+	size_t NextCapacity() const noexcept {
+		return NextCapacity(size_ + 1);
+	}
+
+	// Вместимость, до которой вырастет буфер, чтобы вместить required элементов
+	size_t NextCapacity(size_t required) const noexcept {
+		return GrowthPolicy::NextCapacity(Capacity(), required, sizeof(T));
+	}
+
+	// Добавляет в конец count элементов, скопированных из диапазона, начинающегося с first.
+	// Обеспечивает строгую гарантию безопасности исключений
+	template <typename ForwardIt>
+	void AppendN(ForwardIt first, size_t count) {
+		if (size_ + count > Capacity()) {
+			if constexpr (CAN_REALLOCATE) {
+				Reserve(NextCapacity(size_ + count));
+			}
+			else {
+				RawMemory<T, Allocator> new_data(NextCapacity(size_ + count), data_.GetAllocator());
+				std::uninitialized_copy_n(first, count, new_data + size_);
+				try {
+					RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+				}
+				catch (...) {
+					std::destroy_n(new_data + size_, count);
+					throw;
+				}
+				data_.Swap(new_data);
+				RecordGrowth(size_);
+				size_ += count;
+				return;
+			}
+		}
+		std::uninitialized_copy_n(first, count, end());
+		size_ += count;
+	}
+
+	// Вставляет count элементов из диапазона, начинающегося с first, на позицию index.
+	// При реаллокации и для побайтово переносимых T обеспечивает строгую гарантию безопасности исключений,
+	// в остальных случаях, как и std::vector, базовую
+	template <typename ForwardIt>
+	void InsertN(size_t index, ForwardIt first, size_t count) {
+		if (count == 0) {
+			return;
+		}
+		if (index == size_) {
+			AppendN(first, count);
+			return;
+		}
+		if (size_ + count > Capacity()) {
+			if constexpr (CAN_REALLOCATE) {
+				Reserve(NextCapacity(size_ + count));
+			}
+			else {
+				RawMemory<T, Allocator> new_data(NextCapacity(size_ + count), data_.GetAllocator());
+				std::uninitialized_copy_n(first, count, new_data + index);
+				try {
+					RelocateWithGapN(begin(), size_, index, new_data.GetAddress(), count);
+				}
+				catch (...) {
+					std::destroy_n(new_data + index, count);
+					throw;
+				}
+				data_.Swap(new_data);
+				RecordGrowth(size_);
+				size_ += count;
+				return;
+			}
+		}
+		T* pos = begin() + index;
+		T* old_end = end();
+		const size_t elems_after = size_ - index;
+		if constexpr (IsTriviallyRelocatableV<T>) {
+			std::memmove(static_cast<void*>(pos + count), pos, elems_after * sizeof(T));
+			try {
+				std::uninitialized_copy_n(first, count, pos);
+			}
+			catch (...) {
+				std::memmove(static_cast<void*>(pos), pos + count, elems_after * sizeof(T));
+				throw;
+			}
+			size_ += count;
+		}
+		else if (elems_after > count) {
+			std::uninitialized_move(old_end - count, old_end, old_end);
+			size_ += count;
+			std::move_backward(pos, old_end - count, old_end);
+			std::copy_n(first, count, pos);
+		}
+		else {
+			ForwardIt middle = std::next(first, elems_after);
+			std::uninitialized_copy_n(middle, count - elems_after, old_end);
+			try {
+				std::uninitialized_move(pos, old_end, pos + count);
+			}
+			catch (...) {
+				std::destroy_n(old_end, count - elems_after);
+				throw;
+			}
+			size_ += count;
+			std::copy_n(first, elems_after, pos);
+		}
+	}
+
+	// Заменяет содержимое вектора count элементами из диапазона, начинающегося с first
+	template <typename ForwardIt>
+	void AssignN(ForwardIt first, size_t count) {
+		if (count > Capacity()) {
+			RawMemory<T, Allocator> new_data(count, data_.GetAllocator());
+			std::uninitialized_copy_n(first, count, new_data.GetAddress());
+			std::destroy_n(data_.GetAddress(), size_);
+			data_.Swap(new_data);
+			RecordAllocation();
+		}
+		else if (count <= size_) {
+			std::copy_n(first, count, begin());
+			std::destroy_n(begin() + count, size_ - count);
+		}
+		else {
+			std::copy_n(first, size_, begin());
+			std::uninitialized_copy_n(std::next(first, size_), count - size_, end());
+		}
+		size_ = count;
+	}
+
+	static constexpr size_t DefaultChunkSize() noexcept {
+		return std::max<size_t>(1, FOR_EACH_CHUNK_BYTES / sizeof(T));
+	}
+
+	template <typename U, typename Function>
+	static void ForEachChunkImpl(Span<U> elements, Function& function, size_t chunk_size) {
+		assert(chunk_size > 0);
+		for (size_t offset = 0; offset < elements.Size(); offset += chunk_size) {
+			const size_t count = std::min(chunk_size, elements.Size() - offset);
+			const size_t next = offset + count;
+#if defined(__GNUC__) || defined(__clang__)
+			if (next < elements.Size()) {
+				const char* first = reinterpret_cast<const char*>(elements.Data() + next);
+				const size_t prefetch_bytes = std::min(chunk_size, elements.Size() - next) * sizeof(T);
+				for (size_t line = 0; line < prefetch_bytes; line += CACHE_LINE_SIZE) {
+					__builtin_prefetch(first + line);
+				}
+			}
+#endif
+			function(elements.Subspan(offset, count));
+		}
+	}
+
+	void SwapData(Vector& other) noexcept {
+		data_.Swap(other.data_);
+		std::swap(size_, other.size_);
+	}
+
+	RawMemory<T, Allocator> data_;
 	size_t size_ = 0;
-};
\ No newline at end of file
+#ifdef VECTOR_ENABLE_STATS
+	VectorStats stats_;
+#endif
+};
+
+// Удаляет из вектора все элементы, для которых pred вернул true, и возвращает их количество
+template <typename T, typename Allocator, typename GrowthPolicy, typename Predicate>
+size_t EraseIf(Vector<T, Allocator, GrowthPolicy>& vector, Predicate pred) {
+	return vector.EraseIf(std::move(pred));
+}
@@ -0,0 +1,463 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Набор векторных инструкций, которым исполняются алгоритмы над Vector арифметических типов
+enum class SimdLevel {
+	SCALAR,
+	SSE2,
+	AVX2,
+	AVX512,
+	NEON,
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VECTOR_SIMD_LANES 1
+#define VECTOR_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define VECTOR_SIMD_LANES 0
+#define VECTOR_ALWAYS_INLINE inline
+#endif
+
+#if VECTOR_SIMD_LANES && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+#if VECTOR_SIMD_LANES && defined(__ARM_NEON)
+#define VECTOR_SIMD_NEON 1
+#else
+#define VECTOR_SIMD_NEON 0
+#endif
+
+// Наилучший набор инструкций, поддерживаемый процессором. Определяется один раз при первом вызове
+inline SimdLevel DetectSimdLevel() noexcept {
+#if VECTOR_SIMD_X86
+	static const SimdLevel level = [] {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+			return SimdLevel::AVX512;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			return SimdLevel::AVX2;
+		}
+		if (__builtin_cpu_supports("sse2")) {
+			return SimdLevel::SSE2;
+		}
+		return SimdLevel::SCALAR;
+	}();
+	return level;
+#elif VECTOR_SIMD_NEON
+	// NEON входит в базовый набор инструкций AArch64
+	return SimdLevel::NEON;
+#else
+	return SimdLevel::SCALAR;
+#endif
+}
+
+inline bool IsSimdLevelSupported(SimdLevel level) noexcept {
+	const SimdLevel best = DetectSimdLevel();
+	if (level == SimdLevel::SCALAR || level == best) {
+		return true;
+	}
+	return best != SimdLevel::NEON && level != SimdLevel::NEON && level < best;
+}
+
+// Тип значения выводится только из контейнера, поэтому Fill(v, 0) работает и для Vector<double>
+template <typename T>
+struct NonDeduced {
+	using type = T;
+};
+
+template <typename T>
+using NonDeducedT = typename NonDeduced<T>::type;
+
+// Ядра алгоритмов написаны один раз для векторного регистра шириной WIDTH байт на векторных
+// расширениях GCC и Clang и компилируются отдельно под каждый набор инструкций, а набор выбирается
+// во время выполнения. WIDTH == 0 соответствует обычному скалярному коду
+namespace vector_kernels {
+
+#if VECTOR_SIMD_LANES
+// Регистры передаются только между встраиваемыми функциями, поэтому предупреждения о смене ABI
+// для аргументов шире, чем позволяет базовый набор инструкций, к ним не относятся
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename T, size_t WIDTH>
+struct LaneType {
+	typedef T type __attribute__((vector_size(WIDTH)));
+};
+
+// Регистр из WIDTH / sizeof(T) элементов
+template <typename T, size_t WIDTH>
+using Lane = typename LaneType<T, WIDTH>::type;
+
+// Загрузка и сохранение не требуют выравнивания адреса
+template <size_t WIDTH, typename T>
+VECTOR_ALWAYS_INLINE Lane<T, WIDTH> Load(const T* source) {
+	Lane<T, WIDTH> lane;
+	std::memcpy(&lane, source, WIDTH);
+	return lane;
+}
+
+template <size_t WIDTH, typename T>
+VECTOR_ALWAYS_INLINE void Store(T* destination, const Lane<T, WIDTH>& lane) {
+	std::memcpy(destination, &lane, WIDTH);
+}
+
+// Есть ли в регистре ненулевые биты. Регистр складывается пополам, пока не поместится в uint64_t
+template <size_t WIDTH>
+VECTOR_ALWAYS_INLINE bool AnyBits(const void* lane) {
+	if constexpr (WIDTH == sizeof(uint64_t)) {
+		uint64_t bits;
+		std::memcpy(&bits, lane, sizeof(bits));
+		return bits != 0;
+	}
+	else {
+		using Half = Lane<uint64_t, WIDTH / 2>;
+		Half low;
+		Half high;
+		std::memcpy(&low, lane, WIDTH / 2);
+		std::memcpy(&high, static_cast<const char*>(lane) + WIDTH / 2, WIDTH / 2);
+		const Half folded = low | high;
+		return AnyBits<WIDTH / 2>(&folded);
+	}
+}
+#endif
+
+struct Fill {
+	template <size_t WIDTH, typename T>
+	VECTOR_ALWAYS_INLINE static void Run(T* data, size_t size, T value) {
+		size_t i = 0;
+#if VECTOR_SIMD_LANES
+		if constexpr (WIDTH != 0) {
+			constexpr size_t LANE_SIZE = WIDTH / sizeof(T);
+			const Lane<T, WIDTH> lane = Lane<T, WIDTH>{} + value;
+			for (const size_t blocks_end = size - size % (4 * LANE_SIZE); i != blocks_end; i += 4 * LANE_SIZE) {
+				Store<WIDTH>(data + i, lane);
+				Store<WIDTH>(data + i + LANE_SIZE, lane);
+				Store<WIDTH>(data + i + 2 * LANE_SIZE, lane);
+				Store<WIDTH>(data + i + 3 * LANE_SIZE, lane);
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			data[i] = value;
+		}
+	}
+};
+
+struct Find {
+	template <size_t WIDTH, typename T>
+	VECTOR_ALWAYS_INLINE static size_t Run(const T* data, size_t size, T value) {
+		size_t i = 0;
+#if VECTOR_SIMD_LANES
+		if constexpr (WIDTH != 0) {
+			// Блок из двух регистров проверяется целиком, а позиция совпадения ищется уже в скалярном цикле.
+			// Маски совпадений (-1 или 0) вычитаются, а не объединяются через |: для 512-битных регистров
+			// GCC 12 разбирает | масок на скалярные сравнения
+			constexpr size_t LANE_SIZE = WIDTH / sizeof(T);
+			for (const size_t blocks_end = size - size % (2 * LANE_SIZE); i != blocks_end; i += 2 * LANE_SIZE) {
+				auto matches = Load<WIDTH>(data + i) == value;
+				matches -= Load<WIDTH>(data + i + LANE_SIZE) == value;
+				if (AnyBits<WIDTH>(&matches)) {
+					break;
+				}
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			if (data[i] == value) {
+				return i;
+			}
+		}
+		return size;
+	}
+};
+
+struct Count {
+	template <size_t WIDTH, typename T>
+	VECTOR_ALWAYS_INLINE static size_t Run(const T* data, size_t size, T value) {
+		size_t total = 0;
+		size_t i = 0;
+#if VECTOR_SIMD_LANES
+		if constexpr (WIDTH != 0) {
+			// Сравнение даёт -1 в совпавших дорожках. Счётчики дорожек той же ширины, что и элементы,
+			// поэтому их содержимое сбрасывается в total раньше, чем они могут переполниться
+			constexpr size_t LANE_SIZE = WIDTH / sizeof(T);
+			using Mask = decltype(Lane<T, WIDTH>{} == value);
+			using Counter = std::remove_reference_t<decltype(Mask{}[0])>;
+			constexpr size_t MAX_BLOCKS = std::min<size_t>(std::numeric_limits<Counter>::max(), size_t{1} << 30);
+			const size_t blocks_end = size - size % LANE_SIZE;
+			while (i != blocks_end) {
+				Mask counters{};
+				for (size_t blocks = 0; blocks != MAX_BLOCKS && i != blocks_end; ++blocks, i += LANE_SIZE) {
+					counters -= Load<WIDTH>(data + i) == value;
+				}
+				for (size_t j = 0; j != LANE_SIZE; ++j) {
+					total += static_cast<size_t>(counters[j]);
+				}
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			total += data[i] == value;
+		}
+		return total;
+	}
+};
+
+struct Sum {
+	// Целые числа складываются как беззнаковые, то есть по модулю 2^N, без переполнения знакового типа
+	template <typename T>
+	using Accumulator = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, NonDeduced<T>>::type;
+
+	template <size_t WIDTH, typename T>
+	VECTOR_ALWAYS_INLINE static T Run(const T* values, size_t size) {
+		using Acc = Accumulator<T>;
+		const Acc* data = reinterpret_cast<const Acc*>(values);
+		Acc sum{};
+		size_t i = 0;
+#if VECTOR_SIMD_LANES
+		if constexpr (WIDTH != 0) {
+			// Четыре независимых суммы скрывают задержку сложения
+			constexpr size_t LANE_SIZE = WIDTH / sizeof(T);
+			Lane<Acc, WIDTH> sums[4] = {};
+			for (const size_t blocks_end = size - size % (4 * LANE_SIZE); i != blocks_end; i += 4 * LANE_SIZE) {
+				sums[0] += Load<WIDTH>(data + i);
+				sums[1] += Load<WIDTH>(data + i + LANE_SIZE);
+				sums[2] += Load<WIDTH>(data + i + 2 * LANE_SIZE);
+				sums[3] += Load<WIDTH>(data + i + 3 * LANE_SIZE);
+			}
+			const Lane<Acc, WIDTH> lane = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+			for (size_t j = 0; j != LANE_SIZE; ++j) {
+				sum += lane[j];
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			sum += data[i];
+		}
+		return static_cast<T>(sum);
+	}
+};
+
+struct MinMax {
+	template <size_t WIDTH, typename T>
+	VECTOR_ALWAYS_INLINE static std::pair<T, T> Run(const T* data, size_t size) {
+		T min = data[0];
+		T max = data[0];
+		size_t i = 0;
+#if VECTOR_SIMD_LANES
+		if constexpr (WIDTH != 0) {
+			constexpr size_t LANE_SIZE = WIDTH / sizeof(T);
+			if (size >= LANE_SIZE) {
+				Lane<T, WIDTH> mins = Load<WIDTH>(data);
+				Lane<T, WIDTH> maxs = mins;
+				for (i = LANE_SIZE; i != size - size % LANE_SIZE; i += LANE_SIZE) {
+					const Lane<T, WIDTH> lane = Load<WIDTH>(data + i);
+					mins = lane < mins ? lane : mins;
+					maxs = maxs < lane ? lane : maxs;
+				}
+				for (size_t j = 0; j != LANE_SIZE; ++j) {
+					min = mins[j] < min ? mins[j] : min;
+					max = max < maxs[j] ? maxs[j] : max;
+				}
+			}
+		}
+#endif
+		for (; i < size; ++i) {
+			min = data[i] < min ? data[i] : min;
+			max = max < data[i] ? data[i] : max;
+		}
+		return { min, max };
+	}
+};
+
+struct Transform {
+	template <size_t WIDTH, typename T, typename Function>
+	VECTOR_ALWAYS_INLINE static void Run(const T* source, T* destination, size_t size, Function function) {
+		if (source == destination) {
+			ApplyInPlace<WIDTH>(destination, size, function);
+		}
+		else {
+			Apply<WIDTH>(source, destination, size, function);
+		}
+	}
+
+private:
+	// Число итераций внутреннего цикла кратно ширине регистра, а __restrict исключает пересечение
+	// массивов, поэтому компилятор векторизует вызовы function без проверок во время выполнения
+	template <size_t WIDTH, typename T, typename Function>
+	VECTOR_ALWAYS_INLINE static void Apply(const T* __restrict source, T* __restrict destination, size_t size,
+		Function& function) {
+		size_t i = 0;
+		if constexpr (WIDTH != 0) {
+			constexpr size_t BLOCK_SIZE = 2 * WIDTH / sizeof(T);
+			for (const size_t blocks_end = size - size % BLOCK_SIZE; i != blocks_end; i += BLOCK_SIZE) {
+				for (size_t j = 0; j != BLOCK_SIZE; ++j) {
+					destination[i + j] = function(source[i + j]);
+				}
+			}
+		}
+		for (; i < size; ++i) {
+			destination[i] = function(source[i]);
+		}
+	}
+
+	template <size_t WIDTH, typename T, typename Function>
+	VECTOR_ALWAYS_INLINE static void ApplyInPlace(T* data, size_t size, Function& function) {
+		size_t i = 0;
+		if constexpr (WIDTH != 0) {
+			constexpr size_t BLOCK_SIZE = 2 * WIDTH / sizeof(T);
+			for (const size_t blocks_end = size - size % BLOCK_SIZE; i != blocks_end; i += BLOCK_SIZE) {
+				for (size_t j = 0; j != BLOCK_SIZE; ++j) {
+					data[i + j] = function(data[i + j]);
+				}
+			}
+		}
+		for (; i < size; ++i) {
+			data[i] = function(data[i]);
+		}
+	}
+};
+
+#if VECTOR_SIMD_X86
+template <typename Kernel, typename... Args>
+__attribute__((target("sse2"))) auto RunSse2(Args... args) {
+	return Kernel::template Run<16>(args...);
+}
+
+template <typename Kernel, typename... Args>
+__attribute__((target("avx2"))) auto RunAvx2(Args... args) {
+	return Kernel::template Run<32>(args...);
+}
+
+template <typename Kernel, typename... Args>
+__attribute__((target("avx512f,avx512bw"))) auto RunAvx512(Args... args) {
+	return Kernel::template Run<64>(args...);
+}
+#endif
+
+template <typename Kernel, typename... Args>
+auto Run(SimdLevel level, Args... args) {
+	assert(IsSimdLevelSupported(level));
+	switch (level) {
+#if VECTOR_SIMD_X86
+	case SimdLevel::AVX512:
+		return RunAvx512<Kernel>(args...);
+	case SimdLevel::AVX2:
+		return RunAvx2<Kernel>(args...);
+	case SimdLevel::SSE2:
+		return RunSse2<Kernel>(args...);
+#endif
+#if VECTOR_SIMD_NEON
+	case SimdLevel::NEON:
+		return Kernel::template Run<16>(args...);
+#endif
+	default:
+		return Kernel::template Run<0>(args...);
+	}
+}
+
+#if VECTOR_SIMD_LANES
+#pragma GCC diagnostic pop
+#endif
+
+}  // namespace vector_kernels
+
+template <typename T>
+inline constexpr bool IsSimdArithmeticV = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// Алгоритмы над непрерывным массивом data из size элементов с явно заданным набором инструкций,
+// который должен поддерживаться процессором. Целые числа суммируются по модулю 2^N, а сумма чисел
+// с плавающей точкой может отличаться от последовательного сложения в пределах погрешности округления.
+// Значения NaN в MinMax не поддерживаются
+
+template <typename T>
+void Fill(T* data, size_t size, NonDeducedT<T> value, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	vector_kernels::Run<vector_kernels::Fill>(level, data, size, value);
+}
+
+// Возвращает индекс первого элемента, равного value, или size, если такого нет
+template <typename T>
+size_t Find(const T* data, size_t size, NonDeducedT<T> value, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	return vector_kernels::Run<vector_kernels::Find>(level, data, size, value);
+}
+
+template <typename T>
+size_t Count(const T* data, size_t size, NonDeducedT<T> value, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	return vector_kernels::Run<vector_kernels::Count>(level, data, size, value);
+}
+
+template <typename T>
+T Sum(const T* data, size_t size, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	return vector_kernels::Run<vector_kernels::Sum>(level, data, size);
+}
+
+// Массив не должен быть пустым
+template <typename T>
+std::pair<T, T> MinMax(const T* data, size_t size, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	assert(size != 0);
+	return vector_kernels::Run<vector_kernels::MinMax>(level, data, size);
+}
+
+// Записывает в destination[i] результат function(source[i]). Массивы совпадают или не пересекаются
+template <typename T, typename Function>
+void Transform(const T* source, T* destination, size_t size, Function function, SimdLevel level) {
+	static_assert(IsSimdArithmeticV<T>);
+	vector_kernels::Run<vector_kernels::Transform>(level, source, destination, size, function);
+}
+
+// Те же алгоритмы над Vector с набором инструкций, выбранным по возможностям процессора
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void Fill(Vector<T, Allocator, GrowthPolicy>& vector, NonDeducedT<T> value) {
+	Fill(vector.begin(), vector.Size(), value, DetectSimdLevel());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+typename Vector<T, Allocator, GrowthPolicy>::const_iterator Find(const Vector<T, Allocator, GrowthPolicy>& vector,
+	NonDeducedT<T> value) {
+	return vector.begin() + Find(vector.begin(), vector.Size(), value, DetectSimdLevel());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+size_t Count(const Vector<T, Allocator, GrowthPolicy>& vector, NonDeducedT<T> value) {
+	return Count(vector.begin(), vector.Size(), value, DetectSimdLevel());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+T Sum(const Vector<T, Allocator, GrowthPolicy>& vector) {
+	return Sum(vector.begin(), vector.Size(), DetectSimdLevel());
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+std::pair<T, T> MinMax(const Vector<T, Allocator, GrowthPolicy>& vector) {
+	return MinMax(vector.begin(), vector.Size(), DetectSimdLevel());
+}
+
+// Заменяет каждый элемент вектора результатом function(element)
+template <typename T, typename Allocator, typename GrowthPolicy, typename Function>
+void Transform(Vector<T, Allocator, GrowthPolicy>& vector, Function function) {
+	Transform(vector.begin(), vector.begin(), vector.Size(), function, DetectSimdLevel());
+}
+
+// Заполняет destination результатами function для элементов source, не инициализируя буфер заранее
+template <typename T, typename Allocator, typename GrowthPolicy, typename Function>
+void Transform(const Vector<T, Allocator, GrowthPolicy>& source, Vector<T, Allocator, GrowthPolicy>& destination,
+	Function function) {
+	destination.ResizeUninitialized(source.Size());
+	Transform(source.begin(), destination.begin(), source.Size(), function, DetectSimdLevel());
+}
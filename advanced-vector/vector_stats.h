@@ -0,0 +1,81 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+// Статистика выделений памяти и переноса элементов при росте вектора.
+// Собирается, только если перед подключением vector.h определён макрос VECTOR_ENABLE_STATS,
+// иначе вектор не хранит счётчики и не тратит на них ни байта, ни такта
+struct VectorStats {
+	size_t allocations = 0;
+	size_t bytes_allocated = 0;
+	// Сколько раз элементы переезжали в новый буфер (включая realloc и ShrinkToFit)
+	size_t reallocations = 0;
+	// Сколько раз realloc изменил размер блока на месте: такой рост не выделяет новый блок и не переносит
+	// элементы, поэтому не входит ни в allocations, ни в reallocations, а в bytes_allocated попадает лишь прирост
+	size_t in_place_reallocations = 0;
+	// Элементы, перенесённые при росте конструктором перемещения, копирования или побайтово
+	size_t elements_moved = 0;
+	size_t elements_copied = 0;
+	size_t elements_relocated = 0;
+	size_t peak_capacity = 0;
+};
+
+// Сводная статистика всех векторов программы. Счётчики атомарны, поэтому векторы
+// из разных потоков могут обновлять её одновременно
+class VectorStatsRegistry {
+public:
+	static VectorStatsRegistry& Global() noexcept {
+		static VectorStatsRegistry registry;
+		return registry;
+	}
+
+	VectorStats Snapshot() const noexcept {
+		VectorStats stats;
+		stats.allocations = allocations_.load(std::memory_order_relaxed);
+		stats.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+		stats.reallocations = reallocations_.load(std::memory_order_relaxed);
+		stats.in_place_reallocations = in_place_reallocations_.load(std::memory_order_relaxed);
+		stats.elements_moved = elements_moved_.load(std::memory_order_relaxed);
+		stats.elements_copied = elements_copied_.load(std::memory_order_relaxed);
+		stats.elements_relocated = elements_relocated_.load(std::memory_order_relaxed);
+		stats.peak_capacity = peak_capacity_.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void Reset() noexcept {
+		allocations_ = 0;
+		bytes_allocated_ = 0;
+		reallocations_ = 0;
+		in_place_reallocations_ = 0;
+		elements_moved_ = 0;
+		elements_copied_ = 0;
+		elements_relocated_ = 0;
+		peak_capacity_ = 0;
+	}
+
+	// Добавляет к сводной статистике изменения одного вектора
+	void Add(const VectorStats& delta) noexcept {
+		allocations_.fetch_add(delta.allocations, std::memory_order_relaxed);
+		bytes_allocated_.fetch_add(delta.bytes_allocated, std::memory_order_relaxed);
+		reallocations_.fetch_add(delta.reallocations, std::memory_order_relaxed);
+		in_place_reallocations_.fetch_add(delta.in_place_reallocations, std::memory_order_relaxed);
+		elements_moved_.fetch_add(delta.elements_moved, std::memory_order_relaxed);
+		elements_copied_.fetch_add(delta.elements_copied, std::memory_order_relaxed);
+		elements_relocated_.fetch_add(delta.elements_relocated, std::memory_order_relaxed);
+		size_t peak = peak_capacity_.load(std::memory_order_relaxed);
+		while (peak < delta.peak_capacity
+			&& !peak_capacity_.compare_exchange_weak(peak, delta.peak_capacity, std::memory_order_relaxed)) {
+		}
+	}
+
+private:
+	std::atomic<size_t> allocations_{ 0 };
+	std::atomic<size_t> bytes_allocated_{ 0 };
+	std::atomic<size_t> reallocations_{ 0 };
+	std::atomic<size_t> in_place_reallocations_{ 0 };
+	std::atomic<size_t> elements_moved_{ 0 };
+	std::atomic<size_t> elements_copied_{ 0 };
+	std::atomic<size_t> elements_relocated_{ 0 };
+	std::atomic<size_t> peak_capacity_{ 0 };
+};